@@ -0,0 +1,84 @@
+/*! \file churn.c
+ *  Churn loop: creates a context, registers parameters, parses and destroys everything, over and over.
+ *  Max RSS must stay flat once warmed up, any leak of teardown shows as growth.
+ *
+ *  usage: argparse_churn_bench [--cycles N] [--tolerance KB]
+ */
+
+#include "args.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+static long max_rss_kb() {
+    struct rusage u;
+    getrusage(RUSAGE_SELF, &u);
+    return u.ru_maxrss;
+}
+
+// one cycle, every other cycle takes the result and frees it itself
+static int cycle(int take_result) {
+    static const char* argv[] = { "churn", "-vv", "--level", "a", "b", "x", "--name=z", NULL };
+    args_context_t* ctx = init_args_context();
+    if (!ctx) return 0;
+    argparse_add_parameter(ctx, "level", 'l', "level", 1, 2, 0, NULL);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "name", 0, "name", 1, 1, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 10);
+    argparse_set_positional_arg_name(ctx, "X", "positional");
+    int ret = parse_args(ctx, 7, argv);
+    if (take_result)
+        argparse_parse_result_deinit(argparse_get_last_parse_result(ctx));
+    deinit_args_context(ctx);
+    return ret;
+}
+
+static long get_long(parse_result_t* result, const char* name, long def) {
+    parsed_argument_t a;
+    if (argparse_get_parsed_arg(result, name, &a) != 1 || a.parac < 1)
+        return def;
+    return atol(a.parav[0]);
+}
+
+int main(int argc, const char** argv) {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter_with_args(ctx, "cycles", 'c', "count of cycles (default 3000000)", 1, 1, 0, "N", NULL);
+    argparse_add_parameter_with_args(ctx, "tolerance", 't', "allowed growth of max RSS after warm-up (default 256)", 1, 1, 0, "KB", NULL);
+    if (!parse_args(ctx, argc, argv)) {
+        argparse_print_usage(ctx, argv[0]);
+        deinit_args_context(ctx);
+        return 1;
+    }
+    parse_result_t* result = argparse_get_last_parse_result(ctx);
+    long cycles = get_long(result, "cycles", 3000000);
+    long tolerance = get_long(result, "tolerance", 256);
+    argparse_parse_result_deinit(result);
+    deinit_args_context(ctx);
+    if (cycles < 100 || tolerance < 0) {
+        fprintf(stderr, "error: invalid counts\n");
+        return 1;
+    }
+
+    // the allocator reaches its steady state within the first percent
+    long warm_up = cycles / 100;
+    long warm_rss = 0;
+    for (long i=0; i<cycles; i++) {
+        if (!cycle(i % 2)) {
+            fprintf(stderr, "error: cycle %ld failed to parse\n", i);
+            return 1;
+        }
+        if (i + 1 == warm_up) {
+            warm_rss = max_rss_kb();
+            printf("%10ld cycles  max rss %ld KB\n", i + 1, warm_rss);
+        }
+    }
+    long end_rss = max_rss_kb();
+    printf("%10ld cycles  max rss %ld KB\n", cycles, end_rss);
+    if (end_rss - warm_rss > tolerance) {
+        printf("max rss grew by %ld KB after warm-up\n", end_rss - warm_rss);
+        return 1;
+    }
+    printf("max rss flat after warm-up\n");
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*! \file startup.c
+ *  Startup latency harness: measures each phase of a short-lived CLI in fresh processes,
+ *  with hardware counters (perf_event_open, Linux only) and allocation counts.
+ *
+ *  usage: argparse_startup_bench [--runs N] [--options N] [--args N]
+ */
+
+#define _GNU_SOURCE
+#include "args.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+
+enum {
+    COUNTER_CYCLES = 0,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_CACHE_MISSES,
+    COUNTER_DTLB_MISSES,
+    COUNTER_PAGE_FAULTS,
+    COUNTER_COUNT,
+};
+
+static const char* counter_names[COUNTER_COUNT] = { "cycles", "instrs", "cache-miss", "dtlb-miss", "page-flt" };
+
+enum {
+    PHASE_INIT = 0,
+    PHASE_REGISTER,
+    PHASE_PARSE,
+    PHASE_LOOKUP,
+    PHASE_DEINIT,
+    PHASE_COUNT,
+};
+
+static const char* phase_names[PHASE_COUNT] = { "init", "register", "parse", "lookup", "deinit" };
+
+/* Measurement of a phase */
+typedef struct sample {
+    long long counters[COUNTER_COUNT];  // -1 if not available
+    long long allocations;
+    long long nanoseconds;
+} sample_t;
+
+// =================================================================================
+// counters
+
+static int counter_fds[COUNTER_COUNT];
+
+static int open_counter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void counters_open() {
+    counter_fds[COUNTER_CYCLES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    counter_fds[COUNTER_INSTRUCTIONS] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    counter_fds[COUNTER_CACHE_MISSES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    counter_fds[COUNTER_DTLB_MISSES] = open_counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB
+                                                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    counter_fds[COUNTER_PAGE_FAULTS] = open_counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+}
+
+static long long allocation_count;
+
+static long long now_ns() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+static void phase_begin(sample_t* s) {
+    for (int i=0; i<COUNTER_COUNT; i++) {
+        if (counter_fds[i] < 0) continue;
+        ioctl(counter_fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter_fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+    s->allocations = allocation_count;
+    s->nanoseconds = now_ns();
+}
+
+static void phase_end(sample_t* s) {
+    s->nanoseconds = now_ns() - s->nanoseconds;
+    s->allocations = allocation_count - s->allocations;
+    for (int i=0; i<COUNTER_COUNT; i++) {
+        s->counters[i] = -1;
+        if (counter_fds[i] < 0) continue;
+        ioctl(counter_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        long long v;
+        if (read(counter_fds[i], &v, sizeof(v)) == sizeof(v))
+            s->counters[i] = v;
+    }
+}
+
+// =================================================================================
+// allocator counting every allocation
+
+static void* counting_allocate(void* user, size_t size) {
+    (void)user;
+    allocation_count++;
+    return malloc(size);
+}
+
+static void* counting_reallocate(void* user, void* ptr, size_t size) {
+    (void)user;
+    allocation_count++;
+    return realloc(ptr, size);
+}
+
+static void counting_deallocate(void* user, void* ptr) {
+    (void)user;
+    free(ptr);
+}
+
+static const argparse_allocator_t counting_allocator = {
+    counting_allocate, counting_reallocate, counting_deallocate, NULL
+};
+
+// =================================================================================
+// child: one cold run of all phases, prints one line per phase
+
+static void run_child(int option_count, int arg_count) {
+    sample_t samples[PHASE_COUNT];
+    // prepare names and argv before measuring
+    char (*names)[24] = malloc(option_count * sizeof(*names));
+    const char** argv = malloc((arg_count + 2) * sizeof(char*));
+    for (int i=0; i<option_count; i++)
+        snprintf(names[i], sizeof(names[i]), "option-%d", i);
+    // argv alternates --option-k and its value
+    char (*flags)[32] = malloc((arg_count + 1) * sizeof(*flags));
+    argv[0] = "bench";
+    for (int i=1; i<=arg_count; i++) {
+        if (i % 2) {
+            snprintf(flags[i], sizeof(flags[i]), "--%s", names[(i * 7919) % option_count]);
+            argv[i] = flags[i];
+        }
+        else argv[i] = "value";
+    }
+    argv[arg_count + 1] = NULL;
+    counters_open();
+
+    phase_begin(&samples[PHASE_INIT]);
+    args_context_t* ctx = init_args_context_with_allocator(&counting_allocator);
+    phase_end(&samples[PHASE_INIT]);
+
+    phase_begin(&samples[PHASE_REGISTER]);
+    for (int i=0; i<option_count; i++)
+        argparse_add_parameter(ctx, names[i], 0, "option for startup benchmark", 0, 1, 0, NULL);
+    phase_end(&samples[PHASE_REGISTER]);
+
+    phase_begin(&samples[PHASE_PARSE]);
+    int ret = parse_args(ctx, arg_count + 1, argv);
+    phase_end(&samples[PHASE_PARSE]);
+
+    phase_begin(&samples[PHASE_LOOKUP]);
+    parse_result_t* result = argparse_get_last_parse_result(ctx);
+    int found = 0;
+    parsed_argument_t a;
+    for (int i=0; i<option_count; i++)
+        found += argparse_get_parsed_arg(result, names[i], &a) == 1;
+    phase_end(&samples[PHASE_LOOKUP]);
+
+    phase_begin(&samples[PHASE_DEINIT]);
+    argparse_parse_result_deinit(result);
+    deinit_args_context(ctx);
+    phase_end(&samples[PHASE_DEINIT]);
+
+    if (!ret)
+        fprintf(stderr, "warning: parse failed\n");
+    for (int p=0; p<PHASE_COUNT; p++) {
+        printf("%d", p);
+        for (int i=0; i<COUNTER_COUNT; i++)
+            printf(" %lld", samples[p].counters[i]);
+        printf(" %lld %lld\n", samples[p].allocations, samples[p].nanoseconds);
+    }
+    free(flags);
+    free(argv);
+    free(names);
+    (void)found;
+}
+
+// =================================================================================
+// parent: spawns fresh processes and reports medians
+
+static int compare_ll(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return x < y ? -1 : x > y;
+}
+
+static long long median(long long* v, int n) {
+    qsort(v, n, sizeof(long long), compare_ll);
+    return v[n / 2];
+}
+
+static int spawn_child(const char* self, int option_count, int arg_count, sample_t* _out) {
+    int fds[2];
+    if (pipe(fds)) return 0;
+    pid_t pid = fork();
+    if (pid < 0) return 0;
+    if (pid == 0) {
+        char options[16], args[16];
+        snprintf(options, sizeof(options), "%d", option_count);
+        snprintf(args, sizeof(args), "%d", arg_count);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execl(self, self, "--child", "--options", options, "--args", args, (char*)NULL);
+        _exit(127);
+    }
+    close(fds[1]);
+    FILE* in = fdopen(fds[0], "r");
+    int got = 0, p;
+    while (fscanf(in, "%d", &p) == 1 && p >= 0 && p < PHASE_COUNT) {
+        for (int i=0; i<COUNTER_COUNT; i++)
+            fscanf(in, "%lld", &_out[p].counters[i]);
+        fscanf(in, "%lld %lld", &_out[p].allocations, &_out[p].nanoseconds);
+        got++;
+    }
+    fclose(in);
+    int status;
+    waitpid(pid, &status, 0);
+    return got == PHASE_COUNT && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void report(sample_t (*runs)[PHASE_COUNT], int run_count, int option_count, int arg_count) {
+    long long* v = malloc(run_count * sizeof(long long));
+    printf("startup phases, median of %d fresh processes (%d options, %d args)\n", run_count, option_count, arg_count);
+    printf("%-10s", "phase");
+    for (int i=0; i<COUNTER_COUNT; i++)
+        printf(" %12s", counter_names[i]);
+    printf(" %12s %12s\n", "allocs", "ns");
+    for (int p=0; p<PHASE_COUNT; p++) {
+        printf("%-10s", phase_names[p]);
+        for (int i=0; i<COUNTER_COUNT; i++) {
+            for (int r=0; r<run_count; r++)
+                v[r] = runs[r][p].counters[i];
+            long long m = median(v, run_count);
+            if (m < 0) printf(" %12s", "n/a");
+            else       printf(" %12lld", m);
+        }
+        for (int r=0; r<run_count; r++)
+            v[r] = runs[r][p].allocations;
+        printf(" %12lld", median(v, run_count));
+        for (int r=0; r<run_count; r++)
+            v[r] = runs[r][p].nanoseconds;
+        printf(" %12lld\n", median(v, run_count));
+    }
+    free(v);
+}
+
+static int get_int(parse_result_t* result, const char* name, int def) {
+    parsed_argument_t a;
+    if (argparse_get_parsed_arg(result, name, &a) != 1 || a.parac < 1)
+        return def;
+    return atoi(a.parav[0]);
+}
+
+int main(int argc, const char** argv) {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter_with_args(ctx, "runs", 'r', "count of fresh processes (default 21)", 1, 1, 0, "N", NULL);
+    argparse_add_parameter_with_args(ctx, "options", 'o', "count of registered options (default 1000)", 1, 1, 0, "N", NULL);
+    argparse_add_parameter_with_args(ctx, "args", 'a', "count of parsed args (default 1000)", 1, 1, 0, "N", NULL);
+    argparse_add_parameter(ctx, "child", 0, "run phases once in this process (internal)", 0, 0, 0, NULL);
+    if (!parse_args(ctx, argc, argv)) {
+        argparse_print_usage(ctx, argv[0]);
+        deinit_args_context(ctx);
+        return 1;
+    }
+    parse_result_t* result = argparse_get_last_parse_result(ctx);
+    int run_count = get_int(result, "runs", 21);
+    int option_count = get_int(result, "options", 1000);
+    int arg_count = get_int(result, "args", 1000);
+    int child = argparse_count(result, "child");
+    argparse_parse_result_deinit(result);
+    deinit_args_context(ctx);
+    if (run_count < 1 || option_count < 1 || arg_count < 0) {
+        fprintf(stderr, "error: invalid counts\n");
+        return 1;
+    }
+
+    if (child) {
+        run_child(option_count, arg_count);
+        return 0;
+    }
+    sample_t (*runs)[PHASE_COUNT] = calloc(run_count, sizeof(*runs));
+    for (int r=0; r<run_count; r++) {
+        if (!spawn_child("/proc/self/exe", option_count, arg_count, runs[r])) {
+            fprintf(stderr, "error: run %d failed\n", r);
+            free(runs);
+            return 1;
+        }
+    }
+    report(runs, run_count, option_count, arg_count);
+    free(runs);
+    return 0;
+}
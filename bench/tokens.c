@@ -0,0 +1,92 @@
+/*! \file tokens.c
+ *  Token scan: parses one argv of a million tokens, mostly long options with inline values,
+ *  and reports the time per token. Build with ARGPARSE_SSE2_SCAN to compare the vector scan.
+ *
+ *  usage: argparse_tokens_bench [--args N] [--runs N]
+ */
+
+#include "args.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static long get_long(parse_result_t* result, const char* name, long def) {
+    parsed_argument_t a;
+    if (argparse_get_parsed_arg(result, name, &a) != 1 || a.parac < 1)
+        return def;
+    return atol(a.parav[0]);
+}
+
+// token i of the measured argv, long options dominate since only they are scanned for '='
+static const char* token(long i) {
+    static const char* tokens[] = {
+        "--define=a-fairly-long-key-name=value", "--define=k=v", "--output-directory=/tmp/build/output",
+        "--verbose", "-v", "file.txt", "--output-directory", "/tmp/x",
+    };
+    return tokens[i % (sizeof(tokens) / sizeof(tokens[0]))];
+}
+
+int main(int argc, const char** argv) {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter_with_args(ctx, "args", 'a', "count of tokens (default 1000000)", 1, 1, 0, "N", NULL);
+    argparse_add_parameter_with_args(ctx, "runs", 'r', "count of parses, the best one is reported (default 5)", 1, 1, 0, "N", NULL);
+    if (!parse_args(ctx, argc, argv)) {
+        argparse_print_usage(ctx, argv[0]);
+        deinit_args_context(ctx);
+        return 1;
+    }
+    parse_result_t* result = argparse_get_last_parse_result(ctx);
+    long count = get_long(result, "args", 1000000);
+    long runs = get_long(result, "runs", 5);
+    argparse_parse_result_deinit(result);
+    deinit_args_context(ctx);
+    // an option ending the argv takes the next token, keep the count even
+    if (count < 2 || count > 100000000 || runs < 1) {
+        fprintf(stderr, "error: invalid counts\n");
+        return 1;
+    }
+    count &= ~1L;
+
+    const char** args = (const char**)malloc((count + 2) * sizeof(const char*));
+    if (!args) {
+        fprintf(stderr, "error: out of memory\n");
+        return 1;
+    }
+    args[0] = "tokens";
+    for (long i=0; i<count; i++)
+        args[i + 1] = token(i);
+    args[count + 1] = NULL;
+
+    ctx = init_args_context();
+    argparse_add_parameter(ctx, "define", 'D', "define", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "output-directory", 'o', "output", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_set_positional_args(ctx, 0, (int)count);
+    double best = 0;
+    for (long r=0; r<runs; r++) {
+        double start = now_ns();
+        if (!parse_args(ctx, (int)count + 1, args)) {
+            fprintf(stderr, "error: parse failed\n");
+            return 1;
+        }
+        double elapsed = now_ns() - start;
+        if (r == 0 || elapsed < best)
+            best = elapsed;
+    }
+    deinit_args_context(ctx);
+    free(args);
+#ifdef ARGPARSE_SSE2_SCAN
+    const char* scan = "sse2";
+#else
+    const char* scan = "strcspn";
+#endif
+    printf("%ld tokens  scan %s  best of %ld  %.3f ms  %.2f ns/token\n", count, scan, runs, best / 1e6, best / count);
+    return 0;
+}
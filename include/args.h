@@ -28,6 +28,8 @@ SOFTWARE.
 #define _ACANE_ARGS_C_
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 
 struct args_context;
 
@@ -39,6 +41,11 @@ struct parse_result;
 /// Argument parse result
 typedef struct parse_result parse_result_t;
 
+struct argparse_spec;
+
+/// Hot-reloadable option spec, see argparse_spec_init()
+typedef struct argparse_spec argparse_spec_t;
+
 /// Parsed argument
 typedef struct parsed_argument {
     /// Count of occurrence
@@ -66,6 +73,84 @@ extern "C" {
 /// \return pointer to context
 args_context_t* init_args_context();
 
+/// Allocator used for every allocation made by a context and its parse results
+typedef struct argparse_allocator {
+    /// Allocate `size` bytes, returns NULL on failure
+    void* (*allocate)(void* user, size_t size);
+
+    /// Resize block `ptr` (NULL for a new block) to `size` bytes, returns NULL on failure
+    void* (*reallocate)(void* user, void* ptr, size_t size);
+
+    /// Free block `ptr`
+    void  (*deallocate)(void* user, void* ptr);
+
+    /// User data passed to the functions above
+    void* user;
+} argparse_allocator_t;
+
+/// Create and initialize an argument context with a custom allocator
+///  * the allocator is copied, `user` must outlive the context and every result obtained from it
+/// \param allocator  pointer to allocator (NULL to use malloc/realloc/free)
+/// \return pointer to context
+args_context_t* init_args_context_with_allocator(const argparse_allocator_t* allocator);
+
+/// Copy strings passed to the context instead of borrowing them, for generated options
+///  * covers names, descriptions, parameter names, error messages and choices of parameters, and positional names
+///  * copies are deduplicated in a pool of the context and all freed at once by deinit_args_context()
+///  * disabling only stops copying, strings copied so far are kept
+///  * not available for spec versions and their readers
+/// \param ctx     pointer to context
+/// \param enable  1 to copy strings passed from now on, 0 to borrow them again
+/// \return OK or FAIL
+int argparse_set_owned_strings(args_context_t* ctx, int enable);
+
+/// Derive a context for a subcommand, parameters of `parent` (and its ancestors) are inherited without copying
+///  * only parameters added to the child are allocated, inherited ones resolve at any depth
+///  * inherited names can not be registered again, ids of the child continue after the parent's
+///  * allocator, error handles and help settings are copied from `parent`
+///  * `parent` must outlive the child, and can not get new parameters while it has children
+/// \param parent  pointer to parent context
+/// \return pointer to context (NULL on failure)
+args_context_t* argparse_derive_context(args_context_t* parent);
+
+/// Create a hot-reloadable spec, options are edited in versions and published atomically
+///  * readers (argparse_spec_attach()) parse against the latest version and never wait for writers
+///  * a new version shares unchanged trie nodes and parameters with the previous one
+///  * replaced versions are freed (on next edit or publish) once no reader pins them
+/// \param allocator  pointer to allocator (NULL to use malloc/realloc/free), shared by versions and readers
+/// \return pointer to spec (NULL on failure)
+argparse_spec_t* argparse_spec_init(const argparse_allocator_t* allocator);
+
+/// De-initialize spec, all readers must be de-initialized first
+/// \param spec  pointer to spec
+void argparse_spec_deinit(argparse_spec_t* spec);
+
+/// Start a new version from the published one, writers are serialized until publish or discard
+///  * add parameters to the returned context as usual, or remove them with argparse_remove_parameter()
+///  * parameters of published versions are frozen, and the ids of removed ones are not reused
+///  * constraints and positional settings of versions do not apply to readers
+/// \param spec  pointer to spec
+/// \return pointer to the draft version (NULL on failure), owned by the spec
+args_context_t* argparse_spec_edit(argparse_spec_t* spec);
+
+/// Publish the draft version, must be called from the thread that called argparse_spec_edit()
+/// \param spec  pointer to spec
+/// \return OK or FAIL
+int argparse_spec_publish(argparse_spec_t* spec);
+
+/// Drop the draft version, must be called from the thread that called argparse_spec_edit()
+/// \param spec  pointer to spec
+/// \return OK or FAIL
+int argparse_spec_discard(argparse_spec_t* spec);
+
+/// Create a reader context of a spec, one per thread
+///  * each parse moves to the latest published version, the previous one is released
+///  * results of a parse are valid until the next parse of the reader
+///  * no parameters can be added to a reader, free it with deinit_args_context()
+/// \param spec  pointer to spec
+/// \return pointer to context (NULL on failure)
+args_context_t* argparse_spec_attach(argparse_spec_t* spec);
+
 /// Set count of positional arguments
 /// \param ctx  pointer to context
 /// \param minc min count of positional arguments
@@ -82,6 +167,9 @@ int argparse_set_positional_args(args_context_t* ctx, int minc, int maxc);
 int argparse_set_positional_arg_name(args_context_t* ctx, const char* name, const char* description);
 
 /// De-initialize context
+///  * frees the graph, all parameter info, and the last parse result unless taken by argparse_get_last_parse_result()
+///  * strings passed when registering are borrowed and not freed
+///  * derived contexts must be de-initialized first, otherwise nothing is freed
 /// \param ctx  pointer to context
 void deinit_args_context(args_context_t* ctx);
 
@@ -114,6 +202,14 @@ int argparse_add_parameter_with_args(args_context_t* ctx, const char* long_term,
                    const char* description, int minc, int maxc, int required, const char* arg_name,
                    void (*process)(args_context_t* ctx, int parac, const char** parav));
 
+/// Remove a parameter (both its short term and long term)
+///  * constraints on the parameter are removed, its id is not reused
+///  * results of earlier parses must not be used afterwards
+/// \param ctx      pointer to context
+/// \param argname  short term or long term of the parameter
+/// \return OK or FAIL
+int argparse_remove_parameter(args_context_t* ctx, const char* argname);
+
 /// Set arg name for last added parameter (need to ensure thread safe by user)
 /// \param ctx       pointer to context
 /// \param arg_name  name of argument
@@ -126,6 +222,49 @@ int argparse_set_parameter_name(args_context_t* ctx, const char* arg_name);
 /// \return
 int argparse_set_error_message(args_context_t* ctx, const char* msg);
 
+/// Set valid values for last added parameter (need to ensure thread safe by user)
+///  * values are checked while parsing and can be abbreviated like long terms (e.g., `--level=deb` for `debug`)
+///  * the index of the value is available by argparse_get_choice()
+/// \param ctx      pointer to context
+/// \param choices  valid values (borrowed, must outlive the context)
+/// \param count    count of values
+/// \return OK or FAIL
+int argparse_set_choices(args_context_t* ctx, const char* const* choices, int count);
+
+/// Converter of a bound parameter, writes value into dest
+///  * value is NUL-terminated, for parse_args_views() it is a copy that lives until the next parse of the context
+///  * called with NULL value for every occurrence of a parameter without values
+/// \return OK or FAIL (reported as ARGPARSE_ERROR_INVALID_VALUE)
+typedef int (*argparse_converter_t)(void* dest, const char* value, size_t len);
+
+/// Bind last added parameter to a field, its values are converted into dest while parsing instead of stored in result
+///  * e.g., `argparse_bind(ctx, &config.port, argparse_convert_int)`
+///  * the converter is called for every value, so the last value wins unless it accumulates
+/// \param ctx      pointer to context
+/// \param dest     pointer to field, must outlive parses
+/// \param convert  converter for type of field (NULL to unbind)
+/// \return OK or FAIL
+int argparse_bind(args_context_t* ctx, void* dest, argparse_converter_t convert);
+
+/// Count of 64-bit words of a bitset for `n` parameters
+#define ARGPARSE_BITSET_WORDS(n) (((n) + 63) / 64)
+
+/// Record presence and counts of parameters into caller's memory, both are cleared at the start of every parse
+///  * bit / element `id` belongs to the parameter with id (see argparse_get_parameter_id())
+/// \param ctx       pointer to context
+/// \param presence  bitset of ARGPARSE_BITSET_WORDS(count of parameters) words, can be NULL
+/// \param counts    occurrence count of each parameter, can be NULL
+/// \return OK or FAIL
+int argparse_bind_presence(args_context_t* ctx, uint64_t* presence, int* counts);
+
+/// Converters for argparse_bind()
+int argparse_convert_int(void* dest, const char* value, size_t len);    ///< int, decimal, hex (0x) or octal (0)
+int argparse_convert_long(void* dest, const char* value, size_t len);   ///< long, decimal, hex (0x) or octal (0)
+int argparse_convert_double(void* dest, const char* value, size_t len); ///< double
+int argparse_convert_string(void* dest, const char* value, size_t len); ///< const char*, points into argv (or the copy of a view)
+int argparse_convert_flag(void* dest, const char* value, size_t len);   ///< int, 1 if no value, or 1/0 true/false yes/no on/off
+int argparse_convert_count(void* dest, const char* value, size_t len);  ///< int, increased for every occurrence or value
+
 /// Add parameter meta information (with only long term, without parameter)
 /// \param ctx         pointer to context
 /// \param long_term   long term of the argument (e.g., --flag)
@@ -197,10 +336,11 @@ int argpaese_add_short_leading_parameter(args_context_t* ctx, char short_term, c
                                          void (*process)(args_context_t* ctx, int parac, const char** parav));
 
 /// Add a `--help` parameter to context
+///  * `--help=<pattern>` prints only matching parameters (see argparse_print_help_matching())
 /// \param ctx          pointer to context
 /// \param program_name program name after `usage`
 /// \param description  description (pass NULL to use default)
-/// \return
+/// \return OK or FAIL
 int argparse_add_help_parameter(args_context_t* ctx, const char* program_name, const char* description);
 
 /// Enable remove-ambiguous (i.e., `--`) flag
@@ -213,12 +353,261 @@ void argparse_enable_remove_ambiguous(args_context_t* ctx);
 /// \return OK or FAIL
 int argparse_set_error_handle(args_context_t* ctx, int (*hnd)(const char* __msg));
 
+/// Error codes reported while parsing
+typedef enum argparse_error_code {
+    ARGPARSE_ERROR_NONE = 0,
+    ARGPARSE_ERROR_UNKNOWN_OPTION,      ///< no such option (`text`: the option)
+    ARGPARSE_ERROR_AMBIGUOUS_OPTION,    ///< abbreviation matches several options (`text`: the option)
+    ARGPARSE_ERROR_MISSING_PARAMETER,   ///< too few additional arguments for `option`
+    ARGPARSE_ERROR_UNKNOWN_POSITIONAL,  ///< more positional args than allowed (`text`: the arg)
+    ARGPARSE_ERROR_TOO_FEW_POSITIONAL,  ///< fewer positional args than required (`count`: provided)
+    ARGPARSE_ERROR_MISSING_REQUIRED,    ///< required `option` not present
+    ARGPARSE_ERROR_UNTERMINATED_QUOTE,  ///< command line has an unterminated quote
+    ARGPARSE_ERROR_MUTUALLY_EXCLUSIVE,  ///< `option` used with option of id `count`
+    ARGPARSE_ERROR_REQUIRES,            ///< `option` requires option of id `count`
+    ARGPARSE_ERROR_AT_LEAST_ONE,        ///< none of a group is present (`count`: index of the constraint)
+    ARGPARSE_ERROR_OCCURRENCE,          ///< `option` occurs `count` times, out of its limits
+    ARGPARSE_ERROR_INVALID_CHOICE,      ///< value of `option` is not one of its choices (`text`: the value)
+    ARGPARSE_ERROR_AMBIGUOUS_CHOICE,    ///< value of `option` abbreviates several choices (`text`: the value)
+    ARGPARSE_ERROR_TASK_FAILED,         ///< positional task failed (`count`: positional index, `text`: the arg)
+    ARGPARSE_ERROR_INVALID_VALUE,       ///< value of `option` is rejected by its converter (`text`: the value)
+    ARGPARSE_ERROR_UNEXPECTED_VALUE,    ///< inline value for `option` that takes none, e.g., --verbose=3 (`text`: the value)
+} argparse_error_code_t;
+
+/// Structured error record, no message is formatted until argparse_format_error() is called
+typedef struct argparse_error {
+    /// Error code
+    argparse_error_code_t code;
+
+    /// Index of the offending argument in argv (-1 if not bound to an argument)
+    int argv_index;
+
+    /// Id of the option involved (see argparse_get_parameter_id(), -1 if none)
+    int option;
+
+    /// Byte offset of the problem inside argv[argv_index]
+    int offset;
+
+    /// Offending text, points into argv (NULL if none)
+    const char* text;
+
+    /// Length of text (-1 if NUL-terminated)
+    int text_len;
+
+    /// Count or id related to the error, depending on `code` (e.g., positional args provided)
+    int count;
+} argparse_error_t;
+
+/// Set callback to handle structured errors (takes precedence over argparse_set_error_handle())
+/// \param ctx   pointer to context
+/// \param hnd   function pointer (err: valid during the callback, user: user data)
+/// \param user  user data passed to hnd
+/// \return OK or FAIL
+int argparse_set_error_handle_ex(args_context_t* ctx,
+                                 int (*hnd)(args_context_t* ctx, const argparse_error_t* err, void* user), void* user);
+
+/// Collect all errors in one pass instead of stopping at the first one
+///  * parse_args returns FAIL if any error is collected
+/// \param ctx     pointer to context
+/// \param enable  1 to collect all errors, 0 to stop at the first error (default)
+/// \return OK or FAIL
+int argparse_set_collect_errors(args_context_t* ctx, int enable);
+
+/// Get errors of the last parse (valid until next parse)
+/// \param ctx         pointer to context
+/// \param _out_count  pointer to receive count of errors
+/// \return pointer to errors (NULL if no error)
+const argparse_error_t* argparse_get_errors(args_context_t* ctx, int* _out_count);
+
+/// Format an error message (same as messages passed to the error handle)
+/// \param ctx   pointer to context
+/// \param err   pointer to error
+/// \param buf   buffer to receive message
+/// \param size  size of buffer, the message is truncated if needed
+/// \return length of the full message (like snprintf), -1 on failure
+int argparse_format_error(args_context_t* ctx, const argparse_error_t* err, char* buf, size_t size);
+
+/// Kinds of argv tokens (`data` of ARGPARSE_TRACE_TOKEN events)
+typedef enum argparse_token_kind {
+    ARGPARSE_TOKEN_VALUE = 1,           ///< value or positional arg
+    ARGPARSE_TOKEN_SHORT,               ///< short flags, e.g., -abc, -n=value, -Dvar=value
+    ARGPARSE_TOKEN_LONG,                ///< long flag, e.g., --name
+    ARGPARSE_TOKEN_LONG_VALUE,          ///< long flag with value, e.g., --name=value
+    ARGPARSE_TOKEN_SEPARATOR,           ///< --
+} argparse_token_kind_t;
+
+/// Types of parse trace events, `data` of an event depends on its type
+typedef enum argparse_trace_type {
+    ARGPARSE_TRACE_PARSE = 0,           ///< parse started (`data`: argc)
+    ARGPARSE_TRACE_TOKEN,               ///< argument classified (`data`: argparse_token_kind_t)
+    ARGPARSE_TRACE_NODE,                ///< name looked up in the tries (`data`: depth of the context holding `id`, 0 for own, -1 if not found)
+    ARGPARSE_TRACE_ABBREV,              ///< abbreviation resolved to `id` (`data`: length given)
+    ARGPARSE_TRACE_VALUE,               ///< value attached to `id`, -1 for positional args (`data`: index of value, 0 if bound)
+    ARGPARSE_TRACE_CALLBACK_ENTER,      ///< callback of `id` entered (`data`: parac)
+    ARGPARSE_TRACE_CALLBACK_EXIT,       ///< callback of `id` returned
+    ARGPARSE_TRACE_ERROR,               ///< error reported (`data`: argparse_error_code_t)
+} argparse_trace_type_t;
+
+/// Parse trace event
+typedef struct argparse_trace_event {
+    /// Monotonic clock in nanoseconds
+    uint64_t time_ns;
+
+    /// Type of event (argparse_trace_type_t)
+    int type;
+
+    /// Index of the argument in argv (-1 if not bound to an argument)
+    int argv_index;
+
+    /// Id of the parameter involved (see argparse_get_parameter_id(), -1 if none)
+    int id;
+
+    /// Data depending on `type`
+    int data;
+} argparse_trace_event_t;
+
+/// Record parse events into a ring buffer of the context, the oldest events are overwritten
+///  * disabled by default, costs one branch per event site while disabled
+///  * callbacks run on the thread pool are not traced
+/// \param ctx       pointer to context
+/// \param capacity  count of events kept (rounded up to a power of 2), 0 to disable and free the buffer
+/// \return OK or FAIL
+int argparse_set_trace(args_context_t* ctx, int capacity);
+
+/// Get traced events, oldest first
+/// \param ctx        pointer to context
+/// \param _out_e     receives the most recent events, can be NULL
+/// \param max_count  capacity of _out_e
+/// \return count of events in the buffer
+int argparse_get_trace(args_context_t* ctx, argparse_trace_event_t* _out_e, int max_count);
+
+/// Decode traced events into text, one line per event, oldest first
+/// \param ctx   pointer to context
+/// \param out   output file
+/// \return OK or FAIL
+int argparse_dump_trace(args_context_t* ctx, FILE* out);
+
+/// Count how often the parse loop takes each edge of the name trie and keep the most used children first,
+/// so frequent options resolve in the first probe
+///  * only the context's own parameters adapt, lookups falling through to ancestors leave them untouched
+///  * only names that resolve are counted, unknown and ambiguous ones leave the order as it is
+///  * not available for spec versions and their readers, nor for contexts with derived contexts
+///    (counting pauses while derived contexts exist if enabled before deriving)
+/// \param ctx     pointer to context
+/// \param enable  1 to count and reorder while parsing, 0 to keep the current order
+/// \return OK or FAIL
+int argparse_set_adaptive_lookup(args_context_t* ctx, int enable);
+
+/// Save the counts of the trie edges, one `<count> <name prefix>` line per edge taken
+/// \param ctx   pointer to context
+/// \param path  file of the profile, overwritten
+/// \return OK or FAIL
+int argparse_save_lookup_profile(args_context_t* ctx, const char* path);
+
+/// Add counts saved by argparse_save_lookup_profile() and reorder the trie once,
+/// a short-lived program benefits from previous runs without counting itself
+///  * prefixes unknown to the context are skipped
+/// \param ctx   pointer to context
+/// \param path  file of the profile
+/// \return OK, FAIL if the file cannot be read, for a spec or a context with derived contexts
+int argparse_load_lookup_profile(args_context_t* ctx, const char* path);
+
+/// Defer callbacks of parameters until the whole command line is validated
+///  * callbacks are queued while parsing, and only run if parse_args() succeeds
+///  * a parameter given several times runs once, with its last values
+///  * queued callbacks run by priority (see argparse_set_priority()), then in argv order
+///  * callbacks of positional args and the error handle are not deferred
+/// \param ctx     pointer to context
+/// \param enable  1 to defer callbacks, 0 to run them while parsing (default)
+/// \return OK or FAIL
+int argparse_set_deferred_actions(args_context_t* ctx, int enable);
+
+/// Set priority of deferred callback of last added parameter, higher runs first (default 0)
+/// \param ctx       pointer to context
+/// \param priority  priority
+/// \return OK or FAIL
+int argparse_set_priority(args_context_t* ctx, int priority);
+
+/// Get execution order of deferred callbacks of the last parse (valid until next parse)
+/// \param ctx        pointer to context
+/// \param _out_ids   receives parameter ids (see argparse_get_parameter_id()) in execution order, can be NULL
+/// \param max_count  capacity of _out_ids
+/// \return count of queued callbacks
+int argparse_get_action_order(args_context_t* ctx, int* _out_ids, int max_count);
+
+/// Kinds of constraints between parameters
+typedef enum argparse_constraint_type {
+    ARGPARSE_CONSTRAINT_MUTUALLY_EXCLUSIVE = 0, ///< at most one of the parameters may be present
+    ARGPARSE_CONSTRAINT_REQUIRES,               ///< if the first parameter is present, all the others must be
+    ARGPARSE_CONSTRAINT_AT_LEAST_ONE,           ///< at least one of the parameters must be present
+    ARGPARSE_CONSTRAINT_OCCURRENCE,             ///< set by argparse_set_occurrence_limit()
+} argparse_constraint_type_t;
+
+/// Add a constraint between parameters, checked after parsing together with required parameters
+///  * constraints are compiled into bitmasks over parameter ids, so checking cost does not depend on names
+/// \param ctx      pointer to context
+/// \param type     kind of constraint
+/// \param options  ids of parameters (see argparse_get_parameter_id())
+/// \param count    count of ids
+/// \return OK or FAIL
+int argparse_add_constraint(args_context_t* ctx, argparse_constraint_type_t type, const int* options, int count);
+
+/// Limit how many times a parameter may occur
+/// \param ctx     pointer to context
+/// \param option  id of parameter
+/// \param minc    min count of occurrence
+/// \param maxc    max count of occurrence
+/// \return OK or FAIL
+int argparse_set_occurrence_limit(args_context_t* ctx, int option, int minc, int maxc);
+
+/// Get id of parameter, ids are assigned in registration order starting from 0
+/// \param ctx      pointer to context
+/// \param argname  argument name, can be both short term and long term
+/// \return id of parameter, -1 if not found
+int argparse_get_parameter_id(args_context_t* ctx, const char* argname);
+
 /// Set callback to handle positional args
 /// \param ctx       pointer to context
 /// \param process   callback to process function (index: index of global positional arg, the arg)
 /// \return OK or FAIL
 int argparse_set_positional_arg_process(args_context_t* ctx, void (*process)(int index, const char* arg));
 
+/// Set callback to handle positional args in batches
+///  * called once per run of consecutive positional args, i.e., runs are split by options
+///  * `args` points into argv of parse_args() and is only valid during the callback
+///  * a pending run is also delivered when the parse stops early, e.g., on an error or a directive
+/// \param ctx       pointer to context
+/// \param process   callback to process function (first_index: index of the first global positional arg in this run)
+/// \return OK or FAIL
+int argparse_set_positional_batch_process(args_context_t* ctx, void (*process)(int first_index, int count, const char** args));
+
+/// Create a thread pool owned by the context, replacing the previous one (not available with ARGPARSE_NO_THREADS)
+///  * runs positional tasks (see argparse_set_positional_task()), and deferred callbacks if argparse_set_parallel_actions()
+///  * idle workers steal jobs from busy ones, the thread calling parse_args() works too
+/// \param ctx      pointer to context
+/// \param threads  count of worker threads, 0 to destroy the pool
+/// \return OK or FAIL
+int argparse_set_thread_pool(args_context_t* ctx, int threads);
+
+/// Set task to process every global positional arg, run on the thread pool if any
+///  * tasks run after parse_args() succeeds (and after deferred callbacks), parse_args() returns when all finished
+///  * tasks of the same lane run in index order, one after another; tasks of negative lanes run in any order
+///  * a failed task is reported as ARGPARSE_ERROR_TASK_FAILED and makes parse_args() return FAIL
+///  * tasks may run concurrently, do not call functions on the context from them
+/// \param ctx    pointer to context
+/// \param task   task, returns OK or FAIL
+/// \param lane   callback to get lane of a positional arg, called before any task runs (NULL: all tasks in any order)
+/// \param user   user data passed to task and lane
+/// \return OK or FAIL
+int argparse_set_positional_task(args_context_t* ctx, int (*task)(int index, const char* arg, void* user),
+                                 int (*lane)(int index, const char* arg, void* user), void* user);
+
+/// Run deferred callbacks of the same priority concurrently on the thread pool (see argparse_set_deferred_actions())
+/// \param ctx     pointer to context
+/// \param enable  1 to enable, 0 to run callbacks one by one (default)
+/// \return OK or FAIL
+int argparse_set_parallel_actions(args_context_t* ctx, int enable);
+
 /// Set callback to handle directive positional args
 /// \param ctx       pointer to context
 /// \param process   callback to process function (this function returns 1 if is processed by directive)
@@ -232,6 +621,207 @@ int argparse_set_directive_positional_arg_process(args_context_t* ctx, int (*pro
 /// \return OK or FAIL
 int parse_args(args_context_t* ctx, int argc, const char** argv);
 
+/// View of a string that is not necessarily NUL-terminated
+typedef struct argparse_view {
+    const char* ptr;   ///< first character (NULL entries are skipped like NULL in argv)
+    size_t      len;   ///< length in bytes
+} argparse_view_t;
+
+/// Parse arguments given as views, e.g., slices of a receive buffer, without copying them
+///  * values in the result point into the views, they are not NUL-terminated:
+///    read them with argparse_get_parsed_views() and argparse_get_positional_views()
+///  * callbacks taking strings (parameter, positional, batch, directive callbacks and positional tasks) are not called
+///  * values of bound parameters are copied before conversion (see argparse_bind()),
+///    e.g., strings bound by argparse_convert_string() stay valid until the next parse of the context
+///  * the views and the memory they refer to must outlive the result
+/// \param ctx   pointer to context
+/// \param argc  count of views, including the program name
+/// \param argv  views of arguments
+/// \return OK or FAIL
+int parse_args_views(args_context_t* ctx, int argc, const argparse_view_t* argv);
+
+/// Event kinds produced by the pull parser
+typedef enum argparse_event_type {
+    ARGPARSE_EVENT_END = 0,     ///< no more arguments
+    ARGPARSE_EVENT_OPTION,      ///< an option with its values
+    ARGPARSE_EVENT_POSITIONAL,  ///< a global positional argument
+    ARGPARSE_EVENT_SEPARATOR,   ///< the remove-ambiguous flag `--`
+    ARGPARSE_EVENT_ERROR,       ///< a malformed argument, see `message`
+} argparse_event_type_t;
+
+/// Event produced by argparse_cursor_next()
+typedef struct argparse_event {
+    /// Kind of this event
+    argparse_event_type_t type;
+
+    /// Index in argv of the token producing this event
+    int index;
+
+    /// Index of global positional arg (-1 if not a positional arg)
+    int positional_index;
+
+    /// Long term of the option (NULL if none)
+    const char* long_term;
+
+    /// Short term of the option (0 if none)
+    int short_term;
+
+    /// Parameter count
+    int parac;
+
+    /// Parameter values (point into argv, or into the cursor for inline values)
+    const char** parav;
+
+    /// Error message, valid until the next call on the cursor
+    const char* message;
+} argparse_event_t;
+
+/// Cursor over argv for the pull parser. Fields are private, allocate it on the stack.
+typedef struct argparse_cursor {
+    args_context_t* ctx;
+    int             argc;
+    const char**    argv;
+    int             index;
+    const char*     cluster;
+    int             positional_count;
+    const char*     inline_value;
+    char            error_buf[256];
+} argparse_cursor_t;
+
+/// Initialize a cursor for pull parsing. Neither callbacks nor results are touched,
+/// and no memory is allocated, so callers can stop at any event.
+/// \param cur   pointer to cursor
+/// \param ctx   pointer to context
+/// \param argc  argc of main()
+/// \param argv  argv of main()
+/// \return OK or FAIL
+int argparse_cursor_init(argparse_cursor_t* cur, args_context_t* ctx, int argc, const char** argv);
+
+/// Get next event from the cursor
+///  * end-of-line checks (required args, positional count) are not done by the cursor
+/// \param cur   pointer to cursor
+/// \param ev    pointer to event to receive value
+/// \return OK if an event is produced, FAIL at the end of argv
+int argparse_cursor_next(argparse_cursor_t* cur, argparse_event_t* ev);
+
+struct argparse_interpreter;
+
+/// Line-oriented command interpreter bound to a context
+typedef struct argparse_interpreter argparse_interpreter_t;
+
+/// Split a command line into arguments in place, with shell-compatible quoting
+///  * supports '...', "..." (with \\, \", \$, \` escapes), backslash escapes and `#` comments
+///  * the returned pointers point into `line`, which is modified
+/// \param line      command line to split (NUL-terminated, modified in place)
+/// \param argv      array to receive arguments
+/// \param max_argc  capacity of argv
+/// \return count of arguments, or -1 for unterminated quote or too many arguments
+int argparse_split_line(char* line, const char** argv, int max_argc);
+
+/// Create an interpreter that parses command lines against a reusable context
+///  * argument buffers and the parse result are reused from line to line
+/// \param ctx           pointer to context (not owned by the interpreter)
+/// \param program_name  name passed as argv[0] to parse_args
+/// \return pointer to interpreter
+argparse_interpreter_t* argparse_interpreter_init(args_context_t* ctx, const char* program_name);
+
+/// Tokenize and parse one command line (empty lines and comments are ignored)
+///  * argument values point into `line`, keep it alive while using the parse result
+/// \param it    pointer to interpreter
+/// \param line  command line (NUL-terminated, modified in place)
+/// \return OK or FAIL
+int argparse_interpreter_exec(argparse_interpreter_t* it, char* line);
+
+/// Free interpreter object (the context is not freed, it may be freed before the interpreter)
+/// \param it    pointer to interpreter
+void argparse_interpreter_deinit(argparse_interpreter_t* it);
+
+struct argparse_multicall;
+
+/// Registry of applets of a multi-call (busybox-style) binary
+typedef struct argparse_multicall argparse_multicall_t;
+
+/// Setup function of an applet, adds its parameters to `ctx`
+/// \return OK or FAIL
+typedef int (*argparse_applet_setup_t)(args_context_t* ctx, void* user);
+
+/// Create an applet registry, contexts of applets are only built when selected
+/// \param allocator  pointer to allocator (NULL to use malloc/realloc/free), used by the registry and applet contexts
+/// \return pointer to registry (NULL on failure)
+argparse_multicall_t* argparse_multicall_init(const argparse_allocator_t* allocator);
+
+/// De-initialize registry and the contexts of the applets built so far
+/// \param mc  pointer to registry
+void argparse_multicall_deinit(argparse_multicall_t* mc);
+
+/// Register an applet, only the name is stored until the applet is selected
+/// \param mc     pointer to registry
+/// \param name   name of the applet, must outlive the registry
+/// \param setup  function adding the parameters of the applet
+/// \param user   user data passed to setup
+/// \return OK or FAIL (FAIL if the name is already registered)
+int argparse_multicall_register(argparse_multicall_t* mc, const char* name, argparse_applet_setup_t setup, void* user);
+
+/// Get the context of an applet, built by its setup function on first use
+/// \param mc    pointer to registry
+/// \param name  name of the applet
+/// \return pointer to context (owned by the registry), NULL if unknown or setup failed (a failed setup is not retried)
+args_context_t* argparse_multicall_get(argparse_multicall_t* mc, const char* name);
+
+/// Select an applet by the base name of argv[0], else by argv[1] (`box applet ...`), and parse the arguments with it
+///  * when selected by argv[1], argv[1] becomes the program name of the applet
+/// \param mc        pointer to registry
+/// \param argc      argc passed to main
+/// \param argv      argv passed to main
+/// \param _out_ctx  receives the context of the selected applet (NULL if none), can be NULL
+/// \return OK or FAIL (FAIL if no applet is selected or the setup of the selected one failed)
+int argparse_multicall_parse(argparse_multicall_t* mc, int argc, const char** argv, args_context_t** _out_ctx);
+
+/// Memory used by a context or a parse result (requested bytes, allocator overhead not included)
+typedef struct argparse_memory_stats {
+    /// Context object and graph holder
+    size_t context_bytes;
+
+    /// Trie nodes, including their children lists
+    size_t trie_node_bytes;
+    size_t trie_node_count;
+
+    /// Argument info objects and the argument list
+    size_t arg_info_bytes;
+    size_t arg_info_count;
+
+    /// Positional names and descriptions tables
+    size_t positional_bytes;
+
+    /// Strings owned by the context (see argparse_set_owned_strings()) and copies of bound values of views
+    size_t string_bytes;
+
+    /// Parse result and its items, including parameter lists
+    size_t result_item_bytes;
+    size_t result_item_count;
+
+    /// Sum of all above
+    size_t total_bytes;
+
+    /// Count of live allocations
+    size_t allocation_count;
+
+    /// Peak of total bytes during the last parse_args (context plus the result it built)
+    size_t peak_parse_bytes;
+} argparse_memory_stats_t;
+
+/// Get memory used by a context, including the last result if the context still owns it
+/// \param ctx     pointer to context
+/// \param _out_s  pointer to argparse_memory_stats_t to receive value
+/// \return OK or FAIL
+int argparse_get_memory_stats(args_context_t* ctx, argparse_memory_stats_t* _out_s);
+
+/// Get memory used by a parse result
+/// \param _r      pointer to parse result
+/// \param _out_s  pointer to argparse_memory_stats_t to receive value (context fields are 0)
+/// \return OK or FAIL
+int argparse_get_result_memory_stats(parse_result_t* _r, argparse_memory_stats_t* _out_s);
+
 /// Set help message display width
 /// ```
 ///                            |<---          width       --->|
@@ -252,7 +842,43 @@ int argparse_print_set_help_msg_width(args_context_t* ctx, int width);
 /// \return OK or FAIL
 int argparse_print_set_help_msg_leading_spaces(args_context_t* ctx, int width);
 
-/// Sort parameters
+/// Orders of parameters in help and usage
+typedef enum argparse_order {
+    ARGPARSE_ORDER_REGISTRATION = 0,  ///< registration order, own parameters before inherited ones
+    ARGPARSE_ORDER_ALPHABETICAL,      ///< by long term (short term if none)
+    ARGPARSE_ORDER_REQUIRED_FIRST,    ///< required parameters first, registration order otherwise
+    ARGPARSE_ORDER_SECTION,           ///< grouped by section (see argparse_set_section()), sections in order of first use
+} argparse_order_t;
+
+/// Set section of the last added parameter, grouping it in ARGPARSE_ORDER_SECTION
+///  * parameters without a section come first, help prints a title before each section
+/// \param ctx      pointer to context
+/// \param section  title of the section (borrowed, unless owned strings are enabled)
+/// \return OK or FAIL
+int argparse_set_section(args_context_t* ctx, const char* section);
+
+/// Get ids of parameters (inherited ones too) in an order, registration order is not changed
+///  * orders are sorted once and cached until parameters change
+/// \param ctx        pointer to context
+/// \param order      order of parameters
+/// \param _out_ids   receives ids of parameters (see argparse_get_parameter_id()), can be NULL
+/// \param max_count  capacity of _out_ids
+/// \return count of parameters, -1 if failed
+int argparse_get_parameter_order(args_context_t* ctx, argparse_order_t order, int* _out_ids, int max_count);
+
+/// Set order of parameters in help (argparse_print_help() and help parameter)
+/// \param ctx    pointer to context
+/// \param order  order of parameters
+/// \return OK or FAIL
+int argparse_set_help_order(args_context_t* ctx, argparse_order_t order);
+
+/// Set order of parameters in usage (argparse_print_usage())
+/// \param ctx    pointer to context
+/// \param order  order of parameters
+/// \return OK or FAIL
+int argparse_set_usage_order(args_context_t* ctx, argparse_order_t order);
+
+/// Sort parameters in help and usage alphabetically, same as setting both orders to ARGPARSE_ORDER_ALPHABETICAL
 /// \param ctx   pointer to context
 /// \return OK or FAIL
 int argparse_sort_parameters(args_context_t* ctx);
@@ -262,6 +888,16 @@ int argparse_sort_parameters(args_context_t* ctx);
 /// \return OK or FAIL
 int argparse_print_help(args_context_t* ctx);
 
+/// Print help entries of parameters matching a pattern, in the same layout as argparse_print_help()
+///  * matches names by prefix through the parameter trie, and words of names and descriptions by prefix,
+///    ignoring case, through an index built on the first search (rebuilt once parameters change)
+///  * the default help parameter (see argparse_add_help_parameter()) calls this for `--help=<pattern>`
+///  * an empty pattern prints the whole help like argparse_print_help(), inherited parameters included
+/// \param ctx      pointer to context
+/// \param pattern  prefix of a name or word, leading dashes are ignored
+/// \return count of entries printed, -1 if failed
+int argparse_print_help_matching(args_context_t* ctx, const char* pattern);
+
 /// Print help message for registered positional parameters
 /// \param ctx   pointer to context
 /// \return OK or FAIL
@@ -294,6 +930,7 @@ int argparse_reset_env(args_context_t* ctx);
 
 /// Get the last parse result after call parse_args()
 ///  * the callee will take control of this object, you should free it yourself
+///  * the result refers to parameter info of the context, do not query it after deinit_args_context()
 /// \param ctx   pointer to context
 /// \return pointer to parse result
 parse_result_t* argparse_get_last_parse_result(args_context_t* ctx);
@@ -309,14 +946,165 @@ void argparse_parse_result_deinit(parse_result_t* _r);
 /// \return OK or FAIL
 int argparse_get_parsed_arg(parse_result_t* _r, const char* argname, parsed_argument_t* _out_a);
 
+/// Get all global positional args of parse result in order
+/// \param _r          pointer to parse result
+/// \param _out_count  receives count of positional args
+/// \return array of positional args (owned by parse result), NULL if failed
+const char** argparse_get_positionals(parse_result_t* _r, int* _out_count);
+
+/// Get values of argument as views, works for results of both parse_args() and parse_args_views()
+/// \param _r         pointer to parse result
+/// \param argname    argument name, can be both short term and long term
+/// \param _out_v     receives views of values, can be NULL
+/// \param max_count  capacity of _out_v
+/// \return count of values, -1 if no such argument
+int argparse_get_parsed_views(parse_result_t* _r, const char* argname, argparse_view_t* _out_v, int max_count);
+
+/// Get global positional args of parse result as views
+/// \param _r         pointer to parse result
+/// \param _out_v     receives views of positional args, can be NULL
+/// \param max_count  capacity of _out_v
+/// \return count of positional args, -1 if failed
+int argparse_get_positional_views(parse_result_t* _r, argparse_view_t* _out_v, int max_count);
+
+/// Get index of choice of argument (see argparse_set_choices()), for the last value if multiple values given
+/// \param _r       pointer to parse result
+/// \param argname  argument name, can be both short term and long term
+/// \return index of choice, -1 if argument not present or has no choices
+int argparse_get_choice(parse_result_t* _r, const char* argname);
+
 ///  Get count of argument occurrence
 /// \param _r       pointer to parse result
 /// \param argname  argument name, can be both short term and long term
 /// \return count of argument occurrence
 int argparse_count(parse_result_t* _r, const char* argname);
 
+/// Get size of the snapshot of a parse result
+///  * a snapshot is relocatable (offsets only) and holds copies of names and values, so it outlives argv and the context
+/// \param _r    pointer to parse result
+/// \return size in bytes, 0 if failed
+size_t argparse_snapshot_size(parse_result_t* _r);
+
+/// Write the snapshot of a parse result into a buffer (e.g., a shared memory segment)
+/// \param _r    pointer to parse result
+/// \param buf   buffer of at least argparse_snapshot_size() bytes, aligned to 8 bytes
+/// \param size  capacity of buf
+/// \return bytes written, 0 if failed
+size_t argparse_snapshot_write(parse_result_t* _r, void* buf, size_t size);
+
+/// Write the snapshot of a parse result to a file descriptor (e.g., a memfd inherited across exec)
+///  * not available with ARGPARSE_NO_MMAP
+/// \param _r    pointer to parse result
+/// \param fd    file descriptor, written from its current position
+/// \return OK or FAIL
+int argparse_snapshot_write_fd(parse_result_t* _r, int fd);
+
+/// Attach a snapshot read-only, the result is queried through the result API without parsing again
+///  * values and names point into buf, keep it mapped until argparse_parse_result_deinit()
+/// \param buf   snapshot written by argparse_snapshot_write(), possibly by another process
+/// \param size  bytes available at buf
+/// \return pointer to parse result, NULL if buf is not a valid snapshot
+parse_result_t* argparse_snapshot_attach(const void* buf, size_t size);
+
+/// Map a snapshot from a file descriptor read-only and attach it, unmapped by argparse_parse_result_deinit()
+///  * the snapshot must start at offset 0 of the file, not available with ARGPARSE_NO_MMAP
+/// \param fd    file descriptor of a file written by argparse_snapshot_write_fd()
+/// \return pointer to parse result, NULL if failed
+parse_result_t* argparse_snapshot_attach_fd(int fd);
+
 #ifdef __cplusplus
 }
 #endif
 
+#ifdef __cplusplus
+#include <string>
+#include <vector>
+
+namespace argparse {
+
+/// Converter by field type for argparse::bind()
+template <class T> struct converter;
+template <> struct converter<int> {
+    static int convert(void* d, const char* v, size_t n) { return argparse_convert_int(d, v, n); }
+};
+template <> struct converter<long> {
+    static int convert(void* d, const char* v, size_t n) { return argparse_convert_long(d, v, n); }
+};
+template <> struct converter<double> {
+    static int convert(void* d, const char* v, size_t n) { return argparse_convert_double(d, v, n); }
+};
+template <> struct converter<const char*> {
+    static int convert(void* d, const char* v, size_t n) { return argparse_convert_string(d, v, n); }
+};
+template <> struct converter<bool> {
+    static int convert(void* d, const char* v, size_t n) {
+        int b;
+        if (!argparse_convert_flag(&b, v, n)) return 0;
+        *static_cast<bool*>(d) = b != 0;
+        return 1;
+    }
+};
+template <> struct converter<std::string> {
+    static int convert(void* d, const char* v, size_t n) {
+        if (!v) return 0;
+        static_cast<std::string*>(d)->assign(v, n);
+        return 1;
+    }
+};
+template <class T> struct converter<std::vector<T>> {
+    static int convert(void* d, const char* v, size_t n) {
+        T x{};
+        if (!converter<T>::convert(&x, v, n)) return 0;
+        static_cast<std::vector<T>*>(d)->push_back(std::move(x));
+        return 1;
+    }
+};
+
+template <class> struct member_pointer;
+template <class S, class T> struct member_pointer<T S::*> {
+    using object_type = S;
+    using value_type = T;
+};
+
+/// Bind last added parameter to a member, e.g., `argparse::bind<&config::port>(ctx, cfg)`
+template <auto M>
+inline int bind(args_context_t* ctx, typename member_pointer<decltype(M)>::object_type& obj) {
+    using T = typename member_pointer<decltype(M)>::value_type;
+    return argparse_bind(ctx, &(obj.*M), &converter<T>::convert);
+}
+
+/// Range over pull parser events, e.g., `for (const argparse_event_t& ev : argparse::events(ctx, argc, argv))`
+class events {
+public:
+    class iterator {
+    public:
+        iterator() : cur_(nullptr), ev_() {}
+        explicit iterator(argparse_cursor_t* cur) : cur_(cur), ev_() { ++*this; }
+        const argparse_event_t& operator*() const { return ev_; }
+        const argparse_event_t* operator->() const { return &ev_; }
+        iterator& operator++() {
+            if (cur_ && !argparse_cursor_next(cur_, &ev_))
+                cur_ = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& rhs) const { return cur_ == rhs.cur_; }
+        bool operator!=(const iterator& rhs) const { return cur_ != rhs.cur_; }
+    private:
+        argparse_cursor_t* cur_;
+        argparse_event_t   ev_;
+    };
+
+    events(args_context_t* ctx, int argc, const char** argv) { argparse_cursor_init(&cursor_, ctx, argc, argv); }
+    events(const events&) = delete;
+    events& operator=(const events&) = delete;
+    iterator begin() { return iterator(&cursor_); }
+    iterator end() { return iterator(); }
+
+private:
+    argparse_cursor_t cursor_;
+};
+
+} // namespace argparse
+#endif
+
 #endif //_ACANE_ARGS_C_
\ No newline at end of file
@@ -7,6 +7,34 @@
 #include <string.h>
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <ctype.h>
+#ifndef ARGPARSE_NO_THREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+#ifndef ARGPARSE_NO_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define ARGPARSE_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define ARGPARSE_ASAN
+#endif
+#endif
+// vector scans read aligned blocks past string ends: they never cross a page, but the read is undefined
+// behavior in C and sanitizers reject it, so they are only used when ARGPARSE_SSE2_SCAN is defined
+#if defined(ARGPARSE_SSE2_SCAN) && (defined(__SSE2__) || defined(_M_X64)) && !defined(ARGPARSE_ASAN)
+#include <emmintrin.h>
+#define ARGPARSE_SSE2
+#endif
 
 #define OK     1
 #define FAIL   0
@@ -18,6 +46,10 @@
 #endif // DEBUG
 #define LOGE(fmt, ...) printf("[%s:%d][ ERROR ] " fmt "\n", __FUNCTION__, __LINE__, ##__VA_ARGS__);
 
+#define ARGPARSE_MALLOC(_alloc, _size)         ((_alloc)->allocate((_alloc)->user, (_size)))
+#define ARGPARSE_REALLOC(_alloc, _ptr, _size)  ((_alloc)->reallocate((_alloc)->user, (_ptr), (_size)))
+#define ARGPARSE_FREE(_alloc, _ptr)            ((_alloc)->deallocate((_alloc)->user, (_ptr)))
+
 #define __ACANE_IN_OUT
 #define __ACANE_OUT
 
@@ -31,36 +63,76 @@ typedef struct valarray valarray_t;
 #define ACANE_SIGN 0x77061584
 
 struct parse_result_item;
+struct arg_ctx_graph;
+
+struct arg_help;
 
-/* Arguments info */
+/* Arguments info, the part read while parsing, stored densely by id (see arg_pool_t) in one cache line */
 typedef struct arg_info {
+    void        (*process)(args_context_t* ctx, int parac, const char** parav); // no free parav!
     const char* long_term;
+    struct arg_ctx_graph* choices;    // values are resolved to index through a graph
+
+    // binding, values are converted into dest instead of stored in result
+    void*                bind_dest;
+    argparse_converter_t bind_convert;
+
+    struct arg_help* help;  // cold part, only read for help and errors
+    int         id;         // registration index, public handle of this parameter, also of its result item
+    int         priority;   // deferred action, higher runs first
+    short       min_parameter_count;
+    short       max_parameter_count;  // clamped to PARAMETER_ARGS_COUNT_NO_LIMIT
+    char        short_term;
+    char        directive_flag;   // treat all flags after into parameter of this flag
+    char        required;
+    char        flag;
+} arg_info_t;
+
+/* Arguments info, the part read for help and error messages */
+typedef struct arg_help {
     const char* description;
-    int         short_term;
-    int         min_parameter_count;
-    int         max_parameter_count;
-    int         directive_flag;   // treat all flags after into parameter of this flag
-    void        (*process)(args_context_t* ctx, int parac, const char** parav); // no free parav!
-    int         required;
     const char* arg_name;
     const char* err_msg;
-    int         flag;
+    const char* const* choice_names;
+    int         choice_count;
+    const char* section;      // groups parameters in ARGPARSE_ORDER_SECTION, NULL for none
+    int         refs;         // versions of a spec sharing this parameter, frozen if more than one
 
     // env
-    int         _requirement_satisfied_sign;
     int         _arg_name_sign;
-    struct parse_result_item* result_item;
-} arg_info_t;
+} arg_help_t;
+
+#define ARG_POOL_FIRST_CHUNK 8  // parameters in the first chunk, each next chunk doubles
+#define ARG_POOL_CHUNKS      24 // chunks never move so nodes keep pointers into them
+#define ARG_POOL_ALIGN       64
+
+/* Parameters by id (minus id_base), hot parts packed apart from cold parts in each chunk */
+typedef struct arg_pool {
+    void* chunks[ARG_POOL_CHUNKS];
+} arg_pool_t;
 
 typedef struct parse_result_item {
     arg_info_t* arginfo;
     int count;
-    valarray_t* args; // type: const char*
+    valarray_t* args; // type: const char*, NULL before the first value
+    valarray_t* lens; // lengths of args, only for views (NULL before first used)
+    int choice;       // index of choice of the last value, -1 if none
+    int action_slot;  // position in action queue, valid only if the slot refers back to arginfo
 } parse_result_item_t;
 
 struct parse_result {
-    valarray_t* args;  // type: parse_result_item_t
-    int keep_this_obj; // keep this obj, do not auto free
+    parse_result_item_t* items; // indexed by parameter id (inherited parameters first)
+    int item_count;
+    valarray_t* positionals; // type: const char*, global positional args in order
+    valarray_t* positional_lens; // lengths of positionals, only for views (NULL before first used)
+    int views;         // parsed from views, values are not NUL-terminated
+    size_t bytes;      // requested bytes held by the result, counted as it grows
+    argparse_allocator_t allocator; // copied, the result may outlive its context
+
+    // attached snapshot, values and names point into it
+    arg_info_t* snapshot_args; // names of items, the context may live in another process
+    void* mapping;             // mapped by argparse_snapshot_attach_fd(), unmapped with the result
+    size_t mapping_size;
 };
 
 /* graph nodes */
@@ -68,12 +140,17 @@ typedef struct arg_ctx_node {
     char        ch;
     valarray_t* children;
     arg_info_t* arg_info;
+    int         index;    // value index, for graphs of values (e.g., choices)
+    int         refs;     // graphs sharing this node (versions of a spec), copied before written if shared
     int         _arg_sign;
+    uint32_t    hits;     // lookups through the edge to this node, siblings are ordered by it if adaptive
 } ctx_node_t;
 
 /* args graph-based metadata */
 typedef struct arg_ctx_graph {
     ctx_node_t* head;
+    const argparse_allocator_t* allocator;
+    int adaptive;         // count lookups and move frequent children first
 } ctx_graph_t;
 
 typedef void* val_array_element_t;
@@ -84,12 +161,35 @@ struct valarray {
     val_array_element_t* data;
     size_t   capacity;
     size_t   size;
+    const argparse_allocator_t* allocator;
+};
+
+#define VALARRAY_BYTES(_arr) (sizeof(valarray_t) + (_arr)->capacity * sizeof(val_array_element_t))
+#define VALARRAY_ALLOCATIONS(_arr) (1 + ((_arr)->data != NULL))
+
+void* argparse_default_malloc_(void* user, size_t size) {
+    (void)user;
+    return malloc(size);
+}
+
+void* argparse_default_realloc_(void* user, void* ptr, size_t size) {
+    (void)user;
+    return realloc(ptr, size);
+}
+
+void argparse_default_free_(void* user, void* ptr) {
+    (void)user;
+    free(ptr);
+}
+
+const argparse_allocator_t argparse_default_allocator_ = {
+    argparse_default_malloc_, argparse_default_realloc_, argparse_default_free_, NULL
 };
 
 int valarray_extend_capacity(valarray_t* arr) {
     assert(arr && "arr is not initialized");
     val_array_element_t* _old = arr->data;
-    val_array_element_t* _new = (val_array_element_t*)realloc((void*)_old, sizeof(val_array_element_t) * (arr->capacity + VALARRAY_CAPACITY_PER_INCREASE));
+    val_array_element_t* _new = (val_array_element_t*)ARGPARSE_REALLOC(arr->allocator, (void*)_old, sizeof(val_array_element_t) * (arr->capacity + VALARRAY_CAPACITY_PER_INCREASE));
     if (!_new) {
         LOGE("allocate memory for capacity %lu failed", arr->capacity + 10);
         return FAIL;
@@ -99,12 +199,13 @@ int valarray_extend_capacity(valarray_t* arr) {
     return OK;
 }
 
-int valarray_init(valarray_t** arr) {
-    *arr = (valarray_t*)malloc(sizeof(valarray_t));
+int valarray_init(valarray_t** arr, const argparse_allocator_t* allocator) {
+    *arr = (valarray_t*)ARGPARSE_MALLOC(allocator, sizeof(valarray_t));
     if (!*arr) {
         LOGE("allocate memory failed");
         return FAIL;
     }
+    (*arr)->allocator = allocator;
     (*arr)->capacity = 0;
     (*arr)->size = 0;
     (*arr)->data = NULL;
@@ -145,38 +246,12 @@ size_t valarray_el_index_of(valarray_t* arr, int ch) {
             return i;
     return -1;
 }
-/////
-
-void valarray_element_swap(val_array_element_t* a, val_array_element_t* b) {
-    val_array_element_t t = *a;
-    *a = *b;
-    *b = t;
-}
-
-// quick sort
-int valarray_quick_sort_partition(valarray_t* arr, int s, int e, int (*cmp)(val_array_element_t a, val_array_element_t b)) {
-    int i=s;
-    val_array_element_t x=arr->data[s];
-    for (int j=s; j<=e; j++)
-        if (cmp(arr->data[j], x))
-            valarray_element_swap(&arr->data[++i], &arr->data[j]);
-    valarray_element_swap(&arr->data[i], &arr->data[s]);
-    return i;
-}
-
-void valarray_quick_sort(valarray_t* arr, int s, int e, int (*cmp)(val_array_element_t a, val_array_element_t b)) {
-    if (s >= e)
-        return;
-    int m = valarray_quick_sort_partition(arr, s, e, cmp);
-    valarray_quick_sort(arr, s, m-1, cmp);
-    valarray_quick_sort(arr, m+1, e, cmp);
-}
 
-void valarray_sort(valarray_t* arr, int (*cmp)(val_array_element_t a, val_array_element_t b)) {
-    assert(arr && cmp);
-    valarray_quick_sort(arr, 0, arr->size-1, cmp);
+void valarray_erase(valarray_t* arr, size_t __i) {
+    assert(__i < arr->size);
+    memmove(&arr->data[__i], &arr->data[__i + 1], (arr->size - __i - 1) * sizeof(val_array_element_t));
+    arr->size--;
 }
-
 // foreach
 void valarray_foreach(valarray_t* arr, void (*fn)(val_array_element_t* el)) {
     for (int i=0; i<arr->size; i++) {
@@ -184,41 +259,77 @@ void valarray_foreach(valarray_t* arr, void (*fn)(val_array_element_t* el)) {
     }
 }
 
-// free
+// free the array and its data (elements are owned by the caller)
 void valarray_deinit(valarray_t* arr) {
     if (!arr) return;
-    if (!arr->data) return;
-    free(arr->data);
+    if (arr->data)
+        ARGPARSE_FREE(arr->allocator, arr->data);
+    ARGPARSE_FREE(arr->allocator, arr);
 }
 
 // ==============================================================================
 
-ctx_node_t* ctx_node_init(int ch) {
+ctx_node_t* ctx_node_init(int ch, const argparse_allocator_t* allocator) {
     LOG("construct node with [ch=%c (%d)]", ch, ch);
-    ctx_node_t* __n = (ctx_node_t*)malloc(sizeof(ctx_node_t));
+    ctx_node_t* __n = (ctx_node_t*)ARGPARSE_MALLOC(allocator, sizeof(ctx_node_t));
     if (!__n)
         return NULL;
     __n->ch = ch;
-    int __r = valarray_init(&__n->children);
+    int __r = valarray_init(&__n->children, allocator);
     if (__r != OK) {
         LOG("init children list failed");
-        free(__n);
+        ARGPARSE_FREE(allocator, __n);
         return NULL;
     }
     __n->arg_info = NULL;
+    __n->index = 0;
+    __n->refs = 1;
+    __n->_arg_sign = 0;
+    __n->hits = 0;
     return __n;
 }
 
+void ctx_graph_node_free(ctx_node_t* __n, const argparse_allocator_t* allocator);
+
+// make the node in `slot` writable, a shared node is replaced by a copy sharing its children
+ctx_node_t* ctx_node_own_(ctx_node_t** slot, const argparse_allocator_t* allocator) {
+    ctx_node_t* __n = *slot;
+    if (__n->refs == 1)
+        return __n;
+    ctx_node_t* copy = ctx_node_init(__n->ch, allocator);
+    if (!copy)
+        return NULL;
+    for (size_t i=0; i<__n->children->size; i++) {
+        ctx_node_t* child = __n->children->data[i];
+        if (valarray_push_back(copy->children, child) != OK) {
+            ctx_graph_node_free(copy, allocator);
+            return NULL;
+        }
+        child->refs++;
+    }
+    copy->arg_info = __n->arg_info;
+    copy->index = __n->index;
+    copy->_arg_sign = __n->_arg_sign;
+    copy->hits = __n->hits;
+    __n->refs--;
+    *slot = copy;
+    return copy;
+}
+
 ctx_node_t* ctx_graph_add_nodes(ctx_graph_t* __g, const char* str) {
-    ctx_node_t* node = __g->head;
+    ctx_node_t* node = ctx_node_own_(&__g->head, __g->allocator);
+    if (!node)
+        return NULL;
     for (; *str; ++str) {
         int index = valarray_el_index_of(node->children, *str);
         if (index >= 0) {
             assert(index < node->children->size);
-            node = *valarray_get(node->children, index);
+            node = ctx_node_own_((ctx_node_t**)valarray_get(node->children, index), __g->allocator);
+            if (!node)
+                return NULL;
         }
         else {
-            ctx_node_t* new_node = ctx_node_init(*str);
+            ctx_node_t* new_node = ctx_node_init(*str, __g->allocator);
             valarray_push_back(node->children, new_node);
             node = new_node;
         }
@@ -227,43 +338,464 @@ ctx_node_t* ctx_graph_add_nodes(ctx_graph_t* __g, const char* str) {
     return node;
 }
 
-ctx_graph_t* ctx_graph_init() {
-    ctx_graph_t* __g = (ctx_graph_t*)malloc(sizeof(ctx_graph_t));
+ctx_graph_t* ctx_graph_init(const argparse_allocator_t* allocator) {
+    ctx_graph_t* __g = (ctx_graph_t*)ARGPARSE_MALLOC(allocator, sizeof(ctx_graph_t));
     if (!__g) {
         return NULL;
     }
-    __g->head = ctx_node_init(0);
+    __g->allocator = allocator;
+    __g->head = ctx_node_init(0, allocator);
+    __g->adaptive = 0;
     return __g;
 }
 
-void ctx_graph_node_free(ctx_node_t* __n) {
-    if (!__n)
+void ctx_graph_node_free(ctx_node_t* __n, const argparse_allocator_t* allocator) {
+    if (!__n || --__n->refs > 0)
         return;
     for (int i=0; i<__n->children->size; i++) {
-        ctx_graph_node_free(*valarray_get(__n->children, i));
+        ctx_graph_node_free(*valarray_get(__n->children, i), allocator);
     }
-    free(__n);
+    // arg_info is shared by short and long term nodes, it is owned by args_context_t::args
+    valarray_deinit(__n->children);
+    ARGPARSE_FREE(allocator, __n);
 }
 
 void ctx_graph_free(ctx_graph_t* __g) {
     if (__g) {
-        ctx_graph_node_free(__g->head);
-        free(__g);
+        ctx_graph_node_free(__g->head, __g->allocator);
+        ARGPARSE_FREE(__g->allocator, __g);
+    }
+}
+
+// unmark the end node of `str` in an owned node, pruning nodes left without children or mark
+void ctx_node_remove_(ctx_node_t* node, const char* str, const argparse_allocator_t* allocator) {
+    if (!*str) {
+        node->arg_info = NULL;
+        node->_arg_sign = 0;
+        return;
+    }
+    int index = valarray_el_index_of(node->children, *str);
+    if (index < 0)
+        return;
+    ctx_node_t* child = ctx_node_own_((ctx_node_t**)valarray_get(node->children, index), allocator);
+    if (!child)
+        return;
+    ctx_node_remove_(child, str + 1, allocator);
+    if (!child->children->size && child->_arg_sign != ACANE_SIGN) {
+        valarray_erase(node->children, index);
+        ctx_graph_node_free(child, allocator);
+    }
+}
+
+void ctx_graph_remove_node(ctx_graph_t* __g, const char* str) {
+    ctx_node_t* head = ctx_node_own_(&__g->head, __g->allocator);
+    if (head)
+        ctx_node_remove_(head, str, __g->allocator);
+}
+
+// count a lookup through the child at `index`, moving it ahead of less used siblings, returns its new index
+int ctx_node_hit_(ctx_node_t* node, int index) {
+    ctx_node_t** children = (ctx_node_t**)node->children->data;
+    ctx_node_t* child = children[index];
+    if (child->hits != UINT32_MAX)
+        child->hits++;
+    for (; index > 0 && children[index - 1]->hits < child->hits; index--)
+        children[index] = children[index - 1];
+    children[index] = child;
+    return index;
+}
+
+// order children of a subtree by hits, stable so unused children keep registration order
+void ctx_node_sort_by_hits_(ctx_node_t* node) {
+    ctx_node_t** children = (ctx_node_t**)node->children->data;
+    for (size_t i=1; i<node->children->size; i++) {
+        ctx_node_t* child = children[i];
+        int j = i;
+        for (; j > 0 && children[j - 1]->hits < child->hits; j--)
+            children[j] = children[j - 1];
+        children[j] = child;
+    }
+    for (size_t i=0; i<node->children->size; i++)
+        ctx_node_sort_by_hits_(children[i]);
+}
+
+/// Walk the graph along the first `len` chars of `str`, complete abbreviations if allowed.
+/// Returns the node marked as an end (holding an arg_info or a value index), or NULL.
+/// No parse state is touched.
+ctx_node_t* ctx_graph_find_node(ctx_graph_t* __g, const char* str, size_t len, int allow_abbrev, int* _out_ambiguous) {
+    ctx_node_t* node = __g->head;
+    const char* s = str;
+    const char* end = str + len;
+    *_out_ambiguous = 0;
+    for (; s < end; ++s) {
+        int index = valarray_el_index_of(node->children, *s);
+        if (index < 0) {
+            // no such parameter
+            return NULL;
+        }
+        assert(index < node->children->size);
+        node = *valarray_get(node->children, index);
+    }
+    // If this flag can become an end
+    if (node->arg_info || node->_arg_sign == ACANE_SIGN) {
+        return node;
     }
+    // if the node is not final node, and is not short term, try to find the final node
+    if (allow_abbrev && s != str) {
+        while (node->children->size) {
+            if (node->children->size > 1) {
+                // has one more children, ambiguous flags
+                *_out_ambiguous = 1;
+                return NULL;
+            }
+            // walk to the next node
+            node = *valarray_get(node->children, 0);
+        }
+    }
+    if (node->_arg_sign == ACANE_SIGN) {
+        return node;
+    }
+    // no arg bound to this node
+    return NULL;
+}
+
+// find like ctx_graph_find_node(), if `adapt` the edges of the given chars are counted and moved first,
+// only for a lookup that resolves: unknown or ambiguous names leave the order as it is
+ctx_node_t* ctx_graph_find_node_(ctx_graph_t* __g, const char* str, size_t len, int allow_abbrev, int adapt, int* _out_ambiguous) {
+    ctx_node_t* found = ctx_graph_find_node(__g, str, len, allow_abbrev, _out_ambiguous);
+    if (!found || !adapt)
+        return found;
+    ctx_node_t* node = __g->head;
+    for (const char* s = str; s < str + len; ++s) {
+        int index = ctx_node_hit_(node, valarray_el_index_of(node->children, *s));
+        node = *valarray_get(node->children, index);
+    }
+    return found;
 }
 
 // =================================================================================
 
+#define BITSET_WORDS(_n)        (((_n) + 63) / 64)
+#define BITSET_SET(_b, _i)      ((_b)[(_i) >> 6] |= (uint64_t)1 << ((_i) & 63))
+#define BITSET_TEST(_b, _i)     (((_b)[(_i) >> 6] >> ((_i) & 63)) & 1)
+
+int bitset_lowest_(uint64_t w) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#else
+    int i = 0;
+    while (!(w & 1)) { w >>= 1; i++; }
+    return i;
+#endif
+}
+
+typedef struct constraint {
+    argparse_constraint_type_t type;
+    int  minc;       // occurrence limits
+    int  maxc;
+    int  count;
+    int* options;    // ids, stored after this struct
+} constraint_t;
+
+/* Kind of an argv token, classified before parsing, traced as argparse_token_kind_t */
+enum {
+    ARGV_TOKEN_NONE = 0,                                // NULL
+    ARGV_TOKEN_POSITIONAL = ARGPARSE_TOKEN_VALUE,       // value or positional arg
+    ARGV_TOKEN_SHORT = ARGPARSE_TOKEN_SHORT,            // -abc, -n=value, -Dvar=value (flags from here on)
+    ARGV_TOKEN_LONG = ARGPARSE_TOKEN_LONG,              // --name
+    ARGV_TOKEN_LONG_VALUE = ARGPARSE_TOKEN_LONG_VALUE,  // --name=value
+    ARGV_TOKEN_SEPARATOR = ARGPARSE_TOKEN_SEPARATOR,    // --
+};
+
+typedef struct argv_token {
+    uint32_t eq;     // long tokens: offset of '=' after the leading --, or length of name
+    uint32_t kind;
+} argv_token_t;
+
+/* Deferred action of a parameter */
+typedef struct action {
+    arg_info_t*  arginfo;
+    int          parac;
+    const char** parav;
+} action_t;
+
+/* Job of thread pool, runs items[begin, end) in order */
+typedef struct pool_job {
+    int begin;
+    int end;
+} pool_job_t;
+
+typedef int (*pool_run_item_t)(args_context_t* ctx, int item);  // returns OK or FAIL
+
+#ifndef ARGPARSE_NO_THREADS
+struct thread_pool;
+
+/* Job queue of a worker, owner pops from tail, thieves steal from head */
+typedef struct pool_queue {
+    pthread_mutex_t     lock;
+    int*                jobs;
+    int                 head;
+    int                 tail;
+    struct thread_pool* pool;
+} pool_queue_t;
+
+/* Work-stealing thread pool, runs one batch of jobs at a time */
+typedef struct thread_pool {
+    const argparse_allocator_t* allocator;
+    int             nthreads;
+    pthread_t*      threads;
+    pool_queue_t*   queues;       // one per worker, then one for the calling thread
+    int             queue_count;
+    int             queue_capacity;
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    pthread_cond_t  done;
+    int             generation;   // increased for every batch
+    int             pending;      // jobs not finished in this batch
+    int             stop;
+
+    // current batch
+    args_context_t*   ctx;
+    const pool_job_t* jobs;
+    const int*        items;
+    int*              status;     // status of each item
+    pool_run_item_t   run_item;
+} thread_pool_t;
+
+int pool_take_(thread_pool_t* pool, int self, int* _out_job) {
+    int n = pool->nthreads + 1;
+    for (int k=0; k<n; k++) {
+        pool_queue_t* q = &pool->queues[(self + k) % n];
+        int found = 0;
+        pthread_mutex_lock(&q->lock);
+        if (q->head < q->tail) {
+            *_out_job = k == 0 ? q->jobs[--q->tail] : q->jobs[q->head++];
+            found = 1;
+        }
+        pthread_mutex_unlock(&q->lock);
+        if (found) return 1;
+    }
+    return 0;
+}
+
+void pool_drain_(thread_pool_t* pool, int self) {
+    int job;
+    while (pool_take_(pool, self, &job)) {
+        const pool_job_t* jb = &pool->jobs[job];
+        for (int k=jb->begin; k<jb->end; k++) {
+            int item = pool->items[k];
+            pool->status[item] = pool->run_item(pool->ctx, item);
+        }
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0)
+            pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+void* pool_worker_(void* arg) {
+    pool_queue_t* q = (pool_queue_t*)arg;
+    thread_pool_t* pool = q->pool;
+    int self = (int)(q - pool->queues);
+    int generation = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && generation == pool->generation)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stop) break;
+        generation = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        pool_drain_(pool, self);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+void pool_free_(thread_pool_t* pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i=0; i<pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+    for (int i=0; i<pool->queue_count; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        if (pool->queues[i].jobs)
+            ARGPARSE_FREE(pool->allocator, pool->queues[i].jobs);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    const argparse_allocator_t* allocator = pool->allocator;
+    ARGPARSE_FREE(allocator, pool->threads);
+    ARGPARSE_FREE(allocator, pool->queues);
+    ARGPARSE_FREE(allocator, pool);
+}
+
+thread_pool_t* pool_init_(const argparse_allocator_t* allocator, int nthreads) {
+    thread_pool_t* pool = (thread_pool_t*)ARGPARSE_MALLOC(allocator, sizeof(thread_pool_t));
+    if (!pool) return NULL;
+    memset(pool, 0, sizeof(thread_pool_t));
+    pool->allocator = allocator;
+    pool->threads = (pthread_t*)ARGPARSE_MALLOC(allocator, nthreads * sizeof(pthread_t));
+    pool->queues = (pool_queue_t*)ARGPARSE_MALLOC(allocator, (nthreads + 1) * sizeof(pool_queue_t));
+    if (!pool->threads || !pool->queues) {
+        if (pool->threads) ARGPARSE_FREE(allocator, pool->threads);
+        if (pool->queues) ARGPARSE_FREE(allocator, pool->queues);
+        ARGPARSE_FREE(allocator, pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->queue_count = nthreads + 1;
+    for (int i=0; i<pool->queue_count; i++) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].jobs = NULL;
+        pool->queues[i].head = pool->queues[i].tail = 0;
+        pool->queues[i].pool = pool;
+    }
+    // the pool works with the threads actually started
+    for (; pool->nthreads < nthreads; pool->nthreads++) {
+        if (pthread_create(&pool->threads[pool->nthreads], NULL, pool_worker_, &pool->queues[pool->nthreads]))
+            break;
+    }
+    if (!pool->nthreads) {
+        pool_free_(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+// run jobs on the pool, the calling thread also works until all jobs finish
+int pool_run_(thread_pool_t* pool, args_context_t* ctx, const pool_job_t* jobs, int njobs,
+              const int* items, int* status, pool_run_item_t run_item) {
+    int n = pool->nthreads + 1;
+    // every queue can hold all jobs, so a batch never blocks on a full queue
+    if (njobs > pool->queue_capacity) {
+        for (int i=0; i<pool->queue_count; i++) {
+            pool_queue_t* q = &pool->queues[i];
+            pthread_mutex_lock(&q->lock);
+            int* _new = (int*)ARGPARSE_REALLOC(pool->allocator, q->jobs, njobs * sizeof(int));
+            if (_new) q->jobs = _new;
+            pthread_mutex_unlock(&q->lock);
+            if (!_new) return FAIL;
+        }
+        pool->queue_capacity = njobs;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->ctx = ctx;
+    pool->jobs = jobs;
+    pool->items = items;
+    pool->status = status;
+    pool->run_item = run_item;
+    pool->pending = njobs;
+    pthread_mutex_unlock(&pool->lock);
+    // deal jobs round robin
+    for (int i=0; i<n; i++) {
+        pool_queue_t* q = &pool->queues[i];
+        pthread_mutex_lock(&q->lock);
+        q->head = q->tail = 0;
+        for (int j=i; j<njobs; j+=n)
+            q->jobs[q->tail++] = j;
+        pthread_mutex_unlock(&q->lock);
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_drain_(pool, pool->nthreads);
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    return OK;
+}
+#else
+typedef struct thread_pool thread_pool_t;
+#endif // ARGPARSE_NO_THREADS
+
 #define _DEFAULT_HELP_LINE_WIDTH  (50)
 
+/* Hot-reloadable spec, a chain of immutable versions (contexts) */
+struct argparse_spec {
+    argparse_allocator_t allocator;       // also allocates graphs shared by versions
+    _Atomic(args_context_t*) current;     // published version, pinned once by the spec
+    atomic_int epoch;                     // slot of `readers` new readers enter
+    atomic_int readers[2];                // readers between loading `current` and pinning it
+    args_context_t* draft;                // version being edited, private to the writer
+    valarray_t* retired;                  // type: args_context_t*, replaced versions, freed once unpinned
+    arg_pool_t params;                    // parameters of all versions, ids only grow along versions
+#ifndef ARGPARSE_NO_THREADS
+    pthread_mutex_t lock;                 // serializes writers, held from edit to publish or discard
+#endif
+};
+
 struct args_context {
+    argparse_allocator_t allocator;
     ctx_graph_t* ctx_graph;
+
+    // derived context, parameters of ancestors are shared read-only and resolved after its own
+    struct args_context* parent;
+    int id_base;      // ids of own parameters start after all inherited ones
+    int id_holes;     // ids of removed parameters, never reused
+    int child_count;  // derived contexts alive, parameters are frozen while any
+
+    // hot-reloadable spec, a reader parses against the latest version, pinned as its parent
+    struct argparse_spec* spec;
+    int version;      // a version owned by `spec` rather than a reader
+    atomic_int pins;  // version: readers pinning it, plus one while published
     int (*error_handle)(const char* __msg);
+    int (*error_handle_ex)(args_context_t* ctx, const argparse_error_t* err, void* user);
+    void* error_handle_user;
+
+    // errors of the last parse
+    int collect_errors;
+    argparse_error_t* errors;
+    int error_count;
+    int error_capacity;
+
+    // deferred actions, queued while parsing and run after validation
+    int deferred_actions;
+    struct action* actions;
+    int action_count;
+    int action_capacity;
+
+    // presence bits and counts of parameters by id, provided by caller
+    uint64_t* bind_presence;
+    int* bind_counts;
+
+    // argv tokens of the current parse
+    argv_token_t* tokens;
+    int token_capacity;
+    const char** view_ptrs;   // pointers of views of the current parse, NULL-terminated
+    int view_capacity;
+    int parsing_views;
+
+    // thread pool, runs positional tasks (and deferred actions if parallel_actions)
+    thread_pool_t* pool;
+    int (*positional_task)(int index, const char* arg, void* user);
+    int (*positional_lane)(int index, const char* arg, void* user);
+    void* positional_task_user;
+    int parallel_actions;
+
+    // constraints, compiled into bitmasks over parameter ids before parsing
+    valarray_t* constraints;  // type: constraint_t*
+    int constraints_dirty;
+    int mask_words;           // words per bitmask
+    uint64_t* masks;          // required mask, then one mask per constraint
+    uint64_t* seen;           // parameters present in this parse
+    arg_info_t** args_by_id;
     int current_addi_arg_count;
     int remove_ambiguous;
 
     // process positional args
     void (*process_positional)(int index, const char* arg);
+    void (*process_positional_batch)(int first_index, int count, const char** args); // runs of positional args
+    int run_begin, run_end, run_first; // pending run argv[run_begin, run_end), run_first is its first positional index
     int (*process_directive_positional)(int index, int argc, const char** argv); // returns 1 if processed directive
     int positional_minc;
     int positional_maxc;
@@ -272,30 +804,316 @@ struct args_context {
     int help_line_width;
     int help_leading_spaces;
     FILE* output_file;
+    int help_order;           // argparse_order_t of help and usage
+    int usage_order;
 
     // all arguments
-    valarray_t* args;
+    arg_pool_t params;        // storage of own parameters (versions use the pool of their spec)
+    valarray_t* args;         // type: arg_info_t*, live parameters in registration order
     valarray_t* positional_args;
     valarray_t* positional_args_description;
 
     // env
     arg_info_t* current_arg;
     parse_result_t* last_result;
+    int keep_last_result; // last result is taken by callee, do not auto free
+
+    // memory accounting
+    size_t peak_result_bytes;
+
+    // parse trace, NULL while disabled
+    struct trace_ring* trace;
+
+    // help search, built on first search and rebuilt once parameters change
+    struct help_index* help_index;
+
+    // owned copies of strings, NULL until enabled
+    struct string_pool* strings;
+    // NUL-terminated copies of bound values of views, rewound every parse (only chunks are used)
+    struct string_pool* view_strings;
+
+    // parameters in each order, built on first use and rebuilt once parameters change
+    struct order_views* views;
 };
 
+// result item of a parameter in the current parse
+#define RESULT_ITEM(_ctx, _a) (&(_ctx)->last_result->items[(_a)->id])
+
+// count of parameters including inherited and removed ones, also the next id
+int args_count_(args_context_t* ctx) {
+    return ctx->id_base + ctx->id_holes + (int)ctx->args->size;
+}
+
+// allocator of graphs, versions of a spec share nodes which must outlive every version
+const argparse_allocator_t* graph_allocator_(args_context_t* ctx) {
+    return ctx->version ? &ctx->spec->allocator : &ctx->allocator;
+}
+
+// pool of parameters of a context
+arg_pool_t* params_(args_context_t* ctx) {
+    return ctx->version ? &ctx->spec->params : &ctx->params;
+}
+
+#define ARG_POOL_CHUNK_BYTES(_c) \
+    (ARG_POOL_ALIGN - 1 + ((size_t)ARG_POOL_FIRST_CHUNK << (_c)) * (sizeof(arg_info_t) + sizeof(arg_help_t)))
+
+// hot and cold records at `index` of a pool, the chunk holding it is allocated on demand
+arg_info_t* arg_pool_slot_(arg_pool_t* pool, int index, const argparse_allocator_t* allocator) {
+    // chunk c holds indices [FIRST * (2^c - 1), FIRST * (2^(c+1) - 1))
+    int c = 0;
+    while (c < ARG_POOL_CHUNKS && index >= ARG_POOL_FIRST_CHUNK * ((2 << c) - 1)) c++;
+    if (c >= ARG_POOL_CHUNKS) return NULL;
+    if (!pool->chunks[c]) {
+        pool->chunks[c] = ARGPARSE_MALLOC(allocator, ARG_POOL_CHUNK_BYTES(c));
+        if (!pool->chunks[c]) return NULL;
+    }
+    int size = ARG_POOL_FIRST_CHUNK << c;
+    int offset = index - (size - ARG_POOL_FIRST_CHUNK);
+    // hot records of a chunk are aligned to cache lines, cold records follow all of them
+    arg_info_t* hot = (arg_info_t*)(((uintptr_t)pool->chunks[c] + ARG_POOL_ALIGN - 1) & ~(uintptr_t)(ARG_POOL_ALIGN - 1));
+    arg_help_t* cold = (arg_help_t*)(hot + size);
+    hot[offset].help = &cold[offset];
+    return &hot[offset];
+}
+
+void arg_pool_free_(arg_pool_t* pool, const argparse_allocator_t* allocator) {
+    for (int c=0; c<ARG_POOL_CHUNKS; c++) {
+        if (pool->chunks[c])
+            ARGPARSE_FREE(allocator, pool->chunks[c]);
+        pool->chunks[c] = NULL;
+    }
+}
+
+// =================================================================================
+// interned strings
+
+#define STRING_CHUNK_MIN (4 << 10)
+#define STRING_CHUNK_MAX (1 << 20)
+
+/* chunk of the string pool, followed by `size` bytes */
+typedef struct string_chunk {
+    struct string_chunk* next;
+    size_t used;
+    size_t size;
+} string_chunk_t;
+
+typedef struct interned {
+    const char* str;    // NULL for a free slot
+    uint32_t    hash;
+    uint32_t    len;
+} interned_t;
+
+/* copies of names and descriptions, each distinct string is stored once and all are freed together */
+typedef struct string_pool {
+    int             enabled;
+    string_chunk_t* chunks;   // newest first, allocations are bumped from the newest
+    interned_t*     table;    // open addressing, capacity is a power of 2
+    uint32_t        capacity;
+    uint32_t        count;
+} string_pool_t;
+
+// FNV-1a over the first `len` chars
+uint32_t string_hash_(const char* str, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i=0; i<len; i++)
+        h = (h ^ (unsigned char)str[i]) * 16777619u;
+    return h;
+}
+
+void string_pool_free_(string_pool_t* pool, const argparse_allocator_t* allocator) {
+    if (!pool) return;
+    while (pool->chunks) {
+        string_chunk_t* next = pool->chunks->next;
+        ARGPARSE_FREE(allocator, pool->chunks);
+        pool->chunks = next;
+    }
+    if (pool->table)
+        ARGPARSE_FREE(allocator, pool->table);
+    ARGPARSE_FREE(allocator, pool);
+}
+
+// `size` bytes aligned to `align` (a power of 2), chunks double up to STRING_CHUNK_MAX
+void* string_pool_alloc_(string_pool_t* pool, size_t size, size_t align, const argparse_allocator_t* allocator) {
+    string_chunk_t* c = pool->chunks;
+    size_t offset = c ? (c->used + align - 1) & ~(align - 1) : 0;
+    if (!c || offset + size > c->size) {
+        size_t chunk_size = c ? c->size * 2 : STRING_CHUNK_MIN;
+        if (chunk_size > STRING_CHUNK_MAX) chunk_size = STRING_CHUNK_MAX;
+        if (chunk_size < size) chunk_size = size;
+        c = (string_chunk_t*)ARGPARSE_MALLOC(allocator, sizeof(string_chunk_t) + chunk_size);
+        if (!c) return NULL;
+        c->next = pool->chunks;
+        c->used = 0;
+        c->size = chunk_size;
+        pool->chunks = c;
+        offset = 0;
+    }
+    c->used = offset + size;
+    return (char*)(c + 1) + offset;
+}
+
+// forget all allocations, the newest (largest) chunk is kept for the next round
+void string_pool_rewind_(string_pool_t* pool, const argparse_allocator_t* allocator) {
+    if (!pool || !pool->chunks) return;
+    string_chunk_t* c = pool->chunks->next;
+    while (c) {
+        string_chunk_t* next = c->next;
+        ARGPARSE_FREE(allocator, c);
+        c = next;
+    }
+    pool->chunks->next = NULL;
+    pool->chunks->used = 0;
+}
+
+int string_pool_grow_(string_pool_t* pool, const argparse_allocator_t* allocator) {
+    uint32_t capacity = pool->capacity ? pool->capacity * 2 : 256;
+    interned_t* table = (interned_t*)ARGPARSE_MALLOC(allocator, capacity * sizeof(interned_t));
+    if (!table) return FAIL;
+    memset(table, 0, capacity * sizeof(interned_t));
+    for (uint32_t i=0; i<pool->capacity; i++) {
+        interned_t* e = &pool->table[i];
+        if (!e->str) continue;
+        uint32_t j = e->hash & (capacity - 1);
+        while (table[j].str) j = (j + 1) & (capacity - 1);
+        table[j] = *e;
+    }
+    if (pool->table)
+        ARGPARSE_FREE(allocator, pool->table);
+    pool->table = table;
+    pool->capacity = capacity;
+    return OK;
+}
+
+// replace `*_str` by a copy in the pool if owned strings are enabled, for strings known to be unique
+int string_copy_(args_context_t* ctx, const char** _str) {
+    string_pool_t* pool = ctx->strings;
+    if (!*_str || !pool || !pool->enabled) return OK;
+    size_t size = strlen(*_str) + 1;
+    char* copy = (char*)string_pool_alloc_(pool, size, 1, &ctx->allocator);
+    if (!copy) return FAIL;
+    memcpy(copy, *_str, size);
+    *_str = copy;
+    return OK;
+}
+
+// replace `*_str` by its copy in the pool if owned strings are enabled, equal strings share one copy
+int string_intern_(args_context_t* ctx, const char** _str) {
+    string_pool_t* pool = ctx->strings;
+    if (!*_str || !pool || !pool->enabled) return OK;
+    // keep the load under 3/4 so probes stay short
+    if ((pool->count + 1) * 4 > pool->capacity * 3 && string_pool_grow_(pool, &ctx->allocator) != OK)
+        return FAIL;
+    size_t len = strlen(*_str);
+    uint32_t hash = string_hash_(*_str, len);
+    uint32_t i = hash & (pool->capacity - 1);
+    for (; pool->table[i].str; i = (i + 1) & (pool->capacity - 1)) {
+        interned_t* e = &pool->table[i];
+        if (e->hash == hash && e->len == len && memcmp(e->str, *_str, len) == 0) {
+            *_str = e->str;
+            return OK;
+        }
+    }
+    char* copy = (char*)string_pool_alloc_(pool, len + 1, 1, &ctx->allocator);
+    if (!copy) return FAIL;
+    memcpy(copy, *_str, len + 1);
+    pool->table[i].str = copy;
+    pool->table[i].hash = hash;
+    pool->table[i].len = (uint32_t)len;
+    pool->count++;
+    *_str = copy;
+    return OK;
+}
+
+int argparse_set_owned_strings(args_context_t* ctx, int enable) {
+    if (!ctx) return FAIL;
+    // versions share parameters, a string may outlive the version that copied it
+    if (ctx->spec || ctx->version) {
+        LOGE("owned strings are not available for a spec");
+        return FAIL;
+    }
+    if (!ctx->strings) {
+        if (!enable) return OK;
+        ctx->strings = (string_pool_t*)ARGPARSE_MALLOC(&ctx->allocator, sizeof(string_pool_t));
+        if (!ctx->strings) return FAIL;
+        memset(ctx->strings, 0, sizeof(string_pool_t));
+    }
+    // strings copied so far stay until deinit
+    ctx->strings->enabled = enable != 0;
+    return OK;
+}
+
+// last added parameter, parameters shared by published versions are frozen
+arg_info_t* last_arg_(args_context_t* ctx) {
+    if (!ctx->args->size) return NULL;
+    arg_info_t* _a = ctx->args->data[ctx->args->size-1];
+    if (_a->help->refs > 1) {
+        LOGE("parameter --%s is shared by published versions", _a->long_term ? _a->long_term : "");
+        return NULL;
+    }
+    return _a;
+}
+
 int argparse_default_error_handle(const char* __msg) {
     fprintf(stderr, "error: %s\n", __msg);
     return 0;
 }
 
 args_context_t* init_args_context() {
-    args_context_t* ctx = (args_context_t*)malloc(sizeof(args_context_t));
+    return init_args_context_with_allocator(NULL);
+}
+
+args_context_t* init_args_context_with_allocator(const argparse_allocator_t* allocator) {
+    if (!allocator)
+        allocator = &argparse_default_allocator_;
+    if (!allocator->allocate || !allocator->reallocate || !allocator->deallocate) {
+        LOGE("allocator must provide allocate, reallocate and deallocate");
+        return NULL;
+    }
+    args_context_t* ctx = (args_context_t*)ARGPARSE_MALLOC(allocator, sizeof(args_context_t));
     if (!ctx) return NULL;
-    ctx->ctx_graph = ctx_graph_init();
+    ctx->allocator = *allocator;
+    ctx->ctx_graph = ctx_graph_init(&ctx->allocator);
+    ctx->parent = NULL;
+    ctx->id_base = 0;
+    ctx->id_holes = 0;
+    ctx->child_count = 0;
+    ctx->spec = NULL;
+    ctx->version = 0;
+    atomic_init(&ctx->pins, 0);
     ctx->current_addi_arg_count = 0;
     ctx->current_arg = NULL;
     ctx->error_handle = argparse_default_error_handle;
+    ctx->error_handle_ex = NULL;
+    ctx->error_handle_user = NULL;
+    ctx->collect_errors = 0;
+    ctx->errors = NULL;
+    ctx->error_count = 0;
+    ctx->error_capacity = 0;
+    ctx->deferred_actions = 0;
+    ctx->actions = NULL;
+    ctx->action_count = 0;
+    ctx->action_capacity = 0;
+    ctx->bind_presence = NULL;
+    ctx->bind_counts = NULL;
+    ctx->tokens = NULL;
+    ctx->token_capacity = 0;
+    ctx->view_ptrs = NULL;
+    ctx->view_capacity = 0;
+    ctx->parsing_views = 0;
+    ctx->pool = NULL;
+    ctx->positional_task = NULL;
+    ctx->positional_lane = NULL;
+    ctx->positional_task_user = NULL;
+    ctx->parallel_actions = 0;
+    valarray_init(&ctx->constraints, &ctx->allocator);
+    ctx->constraints_dirty = 1;
+    ctx->mask_words = 0;
+    ctx->masks = NULL;
+    ctx->seen = NULL;
+    ctx->args_by_id = NULL;
     ctx->process_positional = NULL;
+    ctx->process_positional_batch = NULL;
+    ctx->run_begin = ctx->run_end = ctx->run_first = 0;
     ctx->process_directive_positional = NULL;
     ctx->positional_maxc = 0;
     ctx->positional_minc = 0;
@@ -303,36 +1121,107 @@ args_context_t* init_args_context() {
     ctx->help_line_width = _DEFAULT_HELP_LINE_WIDTH;
     ctx->help_leading_spaces = 25;
     ctx->output_file = stdout;
-    valarray_init(&ctx->args);
-    valarray_init(&ctx->positional_args);
-    valarray_init(&ctx->positional_args_description);
+    ctx->help_order = ARGPARSE_ORDER_REGISTRATION;
+    ctx->usage_order = ARGPARSE_ORDER_REGISTRATION;
+    memset(&ctx->params, 0, sizeof(arg_pool_t));
+    valarray_init(&ctx->args, &ctx->allocator);
+    valarray_init(&ctx->positional_args, &ctx->allocator);
+    valarray_init(&ctx->positional_args_description, &ctx->allocator);
     ctx->last_result = NULL;
+    ctx->keep_last_result = 0;
+    ctx->peak_result_bytes = 0;
+    ctx->trace = NULL;
+    ctx->help_index = NULL;
+    ctx->strings = NULL;
+    ctx->view_strings = NULL;
+    ctx->views = NULL;
     return ctx;
 }
 
+args_context_t* argparse_derive_context(args_context_t* parent) {
+    if (!parent) return NULL;
+    if (parent->spec) {
+        LOGE("can not derive from a spec version or reader");
+        return NULL;
+    }
+    args_context_t* ctx = init_args_context_with_allocator(&parent->allocator);
+    if (!ctx) return NULL;
+    ctx->parent = parent;
+    ctx->id_base = args_count_(parent);
+    ctx->error_handle = parent->error_handle;
+    ctx->error_handle_ex = parent->error_handle_ex;
+    ctx->error_handle_user = parent->error_handle_user;
+    ctx->collect_errors = parent->collect_errors;
+    ctx->remove_ambiguous = parent->remove_ambiguous;
+    ctx->help_line_width = parent->help_line_width;
+    ctx->help_leading_spaces = parent->help_leading_spaces;
+    ctx->output_file = parent->output_file;
+    ctx->help_order = parent->help_order;
+    ctx->usage_order = parent->usage_order;
+    parent->child_count++;
+    return ctx;
+}
+
+void help_index_free_(args_context_t* ctx);
+void order_views_free_(args_context_t* ctx);
+
 void deinit_args_context(args_context_t* ctx) {
     if (!ctx) return;
+    if (ctx->child_count) {
+        LOGE("context still has %d derived contexts, deinit them first", ctx->child_count);
+        return;
+    }
+    if (ctx->spec && !ctx->version)
+        atomic_fetch_sub(&ctx->parent->pins, 1);
+    else if (ctx->parent)
+        ctx->parent->child_count--;
     // reset env to free some fields if neededg
     argparse_reset_env(ctx);
+#ifndef ARGPARSE_NO_THREADS
+    pool_free_(ctx->pool);
+#endif
     // deinit graph
     if (ctx->ctx_graph)
         ctx_graph_free(ctx->ctx_graph);
-    // deinit args
-    if (ctx->args && ctx->args->data)
-        free(ctx->args->data);
-    if (ctx->args)
-        free(ctx->args);
-    // deinit positional args
-    if (ctx->positional_args && ctx->positional_args->data)
-        free(ctx->positional_args->data);
-    if (ctx->positional_args)
-        free(ctx->positional_args);
-    if (ctx->positional_args_description && ctx->positional_args_description->data)
-        free(ctx->positional_args_description->data);
-    if (ctx->positional_args_description)
-        free(ctx->positional_args_description);
+    argparse_allocator_t allocator = ctx->allocator;
+    // deinit args, each arg_info appears once in the list, storage is freed with the pool
+    if (ctx->args) {
+        for (int i=0; i<ctx->args->size; i++) {
+            arg_info_t* _a = ctx->args->data[i];
+            if (--_a->help->refs == 0)
+                ctx_graph_free(_a->choices);
+        }
+        valarray_deinit(ctx->args);
+    }
+    arg_pool_free_(&ctx->params, &allocator);
+    if (ctx->errors)
+        ARGPARSE_FREE(&allocator, ctx->errors);
+    if (ctx->actions)
+        ARGPARSE_FREE(&allocator, ctx->actions);
+    if (ctx->tokens)
+        ARGPARSE_FREE(&allocator, ctx->tokens);
+    if (ctx->view_ptrs)
+        ARGPARSE_FREE(&allocator, ctx->view_ptrs);
+    string_pool_free_(ctx->view_strings, &allocator);
+    argparse_set_trace(ctx, 0);
+    help_index_free_(ctx);
+    order_views_free_(ctx);
+    // deinit constraints
+    for (size_t i=0; i<ctx->constraints->size; i++)
+        ARGPARSE_FREE(&allocator, ctx->constraints->data[i]);
+    valarray_deinit(ctx->constraints);
+    if (ctx->masks)
+        ARGPARSE_FREE(&allocator, ctx->masks);
+    if (ctx->seen)
+        ARGPARSE_FREE(&allocator, ctx->seen);
+    if (ctx->args_by_id)
+        ARGPARSE_FREE(&allocator, ctx->args_by_id);
+    // deinit positional args (names and descriptions are borrowed, or owned by the string pool)
+    valarray_deinit(ctx->positional_args);
+    valarray_deinit(ctx->positional_args_description);
+    string_pool_free_(ctx->strings, &allocator);
     // free context
-    free(ctx);
+    ARGPARSE_FREE(&allocator, ctx);
 }
 
 int argparse_set_positional_args(args_context_t* ctx, int minc, int maxc) {
@@ -346,6 +1235,8 @@ int argparse_set_positional_args(args_context_t* ctx, int minc, int maxc) {
 int argparse_set_positional_arg_name(args_context_t* ctx, const char* name, const char* description) {
     if (!ctx)
         return FAIL;
+    if (string_intern_(ctx, &name) != OK || string_intern_(ctx, &description) != OK)
+        return FAIL;
     valarray_push_back(ctx->positional_args, (void*) name);
     valarray_push_back(ctx->positional_args_description, (void*) description);
     return OK;
@@ -354,6 +1245,14 @@ int argparse_set_positional_arg_name(args_context_t* ctx, const char* name, cons
 int regsiter_parameter_on_graph(args_context_t *ctx, const char *param, const char *description, int minc, int maxc,
                                 int required, void (*process)(args_context_t *, int, const char **), int is_long_term,
                                 int is_directive, arg_info_t **arginfo, int flag) {
+    // inherited parameters can not be redefined, a name resolves to the same parameter at any depth
+    for (args_context_t* c = ctx->parent; c; c = c->parent) {
+        int ambiguous;
+        if (ctx_graph_find_node(c->ctx_graph, param, strlen(param), 0, &ambiguous)) {
+            LOGE("parameter %s  already registered by parent context", param);
+            return FAIL;
+        }
+    }
     ctx_node_t* final_node = ctx_graph_add_nodes(ctx->ctx_graph, param);
     if (!final_node) {
         LOGE("add node for --%s failed", param);
@@ -367,8 +1266,25 @@ int regsiter_parameter_on_graph(args_context_t *ctx, const char *param, const ch
     if (arginfo && *arginfo)
         // already as a corresponding arg_info
         final_node->arg_info = *arginfo;
-    else
-        final_node->arg_info = (arg_info_t*) malloc(sizeof(arg_info_t));
+    else {
+        // next slot of the pool, left for the next parameter if registration fails
+        final_node->arg_info = arg_pool_slot_(params_(ctx), args_count_(ctx) - ctx->id_base, &ctx->allocator);
+        if (!final_node->arg_info) {
+            final_node->_arg_sign = 0;
+            return FAIL;
+        }
+        final_node->arg_info->long_term = NULL;
+        final_node->arg_info->short_term = 0;
+        final_node->arg_info->choices = NULL;
+        final_node->arg_info->bind_dest = NULL;
+        final_node->arg_info->bind_convert = NULL;
+        final_node->arg_info->priority = 0;
+        final_node->arg_info->help->choice_names = NULL;
+        final_node->arg_info->help->choice_count = 0;
+        final_node->arg_info->help->section = NULL;
+        final_node->arg_info->help->refs = 1;
+        final_node->arg_info->help->_arg_name_sign = 0;
+    }
     if (is_long_term)
         final_node->arg_info->long_term = param;
     else
@@ -377,15 +1293,15 @@ int regsiter_parameter_on_graph(args_context_t *ctx, const char *param, const ch
         LOG("arginfo already registered, skip");
         return OK;
     }
-    final_node->arg_info->description = description;
-    final_node->arg_info->max_parameter_count = maxc;
-    final_node->arg_info->min_parameter_count = minc;
+    final_node->arg_info->max_parameter_count = maxc > PARAMETER_ARGS_COUNT_NO_LIMIT ? PARAMETER_ARGS_COUNT_NO_LIMIT : maxc;
+    final_node->arg_info->min_parameter_count = minc > PARAMETER_ARGS_COUNT_NO_LIMIT ? PARAMETER_ARGS_COUNT_NO_LIMIT : minc;
     final_node->arg_info->process = process;
     final_node->arg_info->directive_flag = is_directive;
     final_node->arg_info->required = required;
-    final_node->arg_info->arg_name = NULL;
     final_node->arg_info->flag = flag;
-    final_node->arg_info->err_msg = NULL;
+    final_node->arg_info->help->description = description;
+    final_node->arg_info->help->arg_name = NULL;
+    final_node->arg_info->help->err_msg = NULL;
     if (arginfo)
         *arginfo = final_node->arg_info;
     return OK;
@@ -400,6 +1316,13 @@ add_parameter_with_args_(args_context_t *ctx, const char *long_term, char short_
         LOGE("at least one of long_term and short_term should be provided");
         return FAIL;
     }
+    if (ctx->child_count || (ctx->spec && !ctx->version)) {
+        LOGE("parameters of a context are frozen while it has derived contexts or reads a spec");
+        return FAIL;
+    }
+    // names are unique, descriptions of generated options often repeat
+    if (string_copy_(ctx, &long_term) != OK || string_intern_(ctx, &description) != OK)
+        return FAIL;
     arg_info_t* arginfo = NULL;
     // register short term
     if (short_term) {
@@ -414,18 +1337,77 @@ add_parameter_with_args_(args_context_t *ctx, const char *long_term, char short_
     if (long_term) {
         int ret = regsiter_parameter_on_graph(ctx, long_term, description, minc, maxc, required, process, 1,
                                               is_directive, &arginfo, flag);
-        if (ret != OK)
+        if (ret != OK) {
+            // detach the arg_info already bound to short term, nobody else owns it
+            if (arginfo) {
+                char __short_term[2] = { 0, 0 };
+                __short_term[0] = short_term;
+                int ambiguous;
+                ctx_node_t* node = ctx_graph_find_node(ctx->ctx_graph, __short_term, 1, 0, &ambiguous);
+                if (node) {
+                    node->arg_info = NULL;
+                    node->_arg_sign = 0;
+                }
+            }
             return ret;
+        }
     }
     // register parameter on context
     if (arginfo) {
         if (short_term) arginfo->short_term = short_term;
+        arginfo->id = args_count_(ctx);
         valarray_push_back(ctx->args, (void *) arginfo);
+        ctx->constraints_dirty = 1;
         LOG("add arg_info to args [args.size=%zu]", ctx->args->size);
     }
     return OK;
 }
 
+int argparse_remove_parameter(args_context_t* ctx, const char* argname) {
+    if (!ctx || !argname || !*argname) return FAIL;
+    if (ctx->child_count || (ctx->spec && !ctx->version)) {
+        LOGE("parameters of a context are frozen while it has derived contexts or reads a spec");
+        return FAIL;
+    }
+    int ambiguous;
+    ctx_node_t* node = ctx_graph_find_node(ctx->ctx_graph, argname, strlen(argname), 0, &ambiguous);
+    if (!node || !node->arg_info) {
+        LOGE("parameter %s is not registered", argname);
+        return FAIL;
+    }
+    arg_info_t* _a = node->arg_info;
+    if (_a->short_term) {
+        char __short_term[2] = { 0, 0 };
+        __short_term[0] = _a->short_term;
+        ctx_graph_remove_node(ctx->ctx_graph, __short_term);
+    }
+    if (_a->long_term)
+        ctx_graph_remove_node(ctx->ctx_graph, _a->long_term);
+    for (int i=0; i<ctx->args->size; i++) {
+        if (ctx->args->data[i] == _a) {
+            valarray_erase(ctx->args, i);
+            break;
+        }
+    }
+    ctx->id_holes++;
+    // constraints on it can not be checked anymore
+    for (size_t i=0; i<ctx->constraints->size; ) {
+        constraint_t* c = ctx->constraints->data[i];
+        int j = 0;
+        while (j < c->count && c->options[j] != _a->id) j++;
+        if (j < c->count) {
+            ARGPARSE_FREE(&ctx->allocator, c);
+            valarray_erase(ctx->constraints, i);
+        }
+        else i++;
+    }
+    ctx->constraints_dirty = 1;
+    // the slot stays as a hole, its id is never reused
+    if (--_a->help->refs == 0)
+        ctx_graph_free(_a->choices);
+    return OK;
+}
+
 int argparse_add_parameter_with_args(args_context_t* ctx, const char* long_term, char short_term,
                                      const char* description, int minc, int maxc, int required, const char* arg_name,
                                      void (*process)(args_context_t* ctx, int parac, const char** parav)) {
@@ -434,7 +1416,10 @@ int argparse_add_parameter_with_args(args_context_t* ctx, const char* long_term,
     while (_locked);
     _locked = 1;
     int ret = add_parameter_with_args_(ctx, long_term, short_term, description, minc, maxc, required, process, 0, 0);
-    if (!ret) return FAIL;
+    if (!ret) {
+        _locked = 0;
+        return FAIL;
+    }
     argparse_set_parameter_name(ctx, arg_name);
     _locked = 0;
     return OK;
@@ -442,26 +1427,167 @@ int argparse_add_parameter_with_args(args_context_t* ctx, const char* long_term,
 
 int argparse_set_parameter_name(args_context_t* ctx, const char* arg_name) {
     if (!ctx) return FAIL;
-    arg_info_t* _a = ctx->args->data[ctx->args->size-1];
-    _a->_arg_name_sign = ACANE_SIGN;
-    _a->arg_name = arg_name;
+    arg_info_t* _a = last_arg_(ctx);
+    if (!_a || string_intern_(ctx, &arg_name) != OK) return FAIL;
+    _a->help->_arg_name_sign = ACANE_SIGN;
+    _a->help->arg_name = arg_name;
     return OK;
 }
 
 int argparse_set_error_message(args_context_t* ctx, const char* msg) {
     if (!ctx) return FAIL;
-    arg_info_t* _a = ctx->args->data[ctx->args->size-1];
-    _a->err_msg = msg;
+    arg_info_t* _a = last_arg_(ctx);
+    if (!_a || string_intern_(ctx, &msg) != OK) return FAIL;
+    _a->help->err_msg = msg;
     return OK;
 }
 
-int add_parameter_with_args(args_context_t* ctx, const char* long_term, char short_term,
-                  const char* description, int minc, int maxc, int required,
-                  void (*process)(args_context_t* ctx, int parac, const char** parav)) {
-    return add_parameter_with_args_(ctx, long_term, short_term, description, minc, maxc, required, process, 0, 0);
+int argparse_set_choices(args_context_t* ctx, const char* const* choices, int count) {
+    if (!ctx || !choices || count <= 0) return FAIL;
+    arg_info_t* _a = last_arg_(ctx);
+    if (!_a) return FAIL;
+    ctx_graph_t* g = ctx_graph_init(graph_allocator_(ctx));
+    if (!g) return FAIL;
+    for (int i=0; i<count; i++) {
+        ctx_node_t* node = ctx_graph_add_nodes(g, choices[i]);
+        if (!node || node == g->head || node->_arg_sign == ACANE_SIGN) {
+            LOGE("invalid or duplicated choice: %s", choices[i]);
+            ctx_graph_free(g);
+            return FAIL;
+        }
+        node->_arg_sign = ACANE_SIGN;
+        node->index = i;
+    }
+    // owned choices get an owned list, the graph already holds copies of the chars
+    if (ctx->strings && ctx->strings->enabled) {
+        const char** owned = (const char**)string_pool_alloc_(ctx->strings, count * sizeof(const char*),
+                                                              sizeof(const char*), &ctx->allocator);
+        for (int i=0; owned && i<count; i++) {
+            owned[i] = choices[i];
+            if (string_intern_(ctx, &owned[i]) != OK)
+                owned = NULL;
+        }
+        if (!owned) {
+            ctx_graph_free(g);
+            return FAIL;
+        }
+        choices = owned;
+    }
+    ctx_graph_free(_a->choices);
+    _a->choices = g;
+    _a->help->choice_names = choices;
+    _a->help->choice_count = count;
+    return OK;
 }
 
-int argparse_add_parameter_directive(args_context_t* ctx, const char* long_term, char short_term,
+int argparse_set_section(args_context_t* ctx, const char* section) {
+    if (!ctx) return FAIL;
+    if (ctx->child_count) {
+        LOGE("parameters of a context are frozen while it has derived contexts or reads a spec");
+        return FAIL;
+    }
+    arg_info_t* _a = last_arg_(ctx);
+    if (!_a || string_intern_(ctx, &section) != OK) return FAIL;
+    _a->help->section = section;
+    order_views_free_(ctx);
+    return OK;
+}
+
+int argparse_set_priority(args_context_t* ctx, int priority) {
+    if (!ctx) return FAIL;
+    arg_info_t* _a = last_arg_(ctx);
+    if (!_a) return FAIL;
+    _a->priority = priority;
+    return OK;
+}
+
+int argparse_bind(args_context_t* ctx, void* dest, argparse_converter_t convert) {
+    if (!ctx || (convert && !dest)) return FAIL;
+    arg_info_t* _a = last_arg_(ctx);
+    if (!_a) return FAIL;
+    _a->bind_dest = dest;
+    _a->bind_convert = convert;
+    return OK;
+}
+
+int argparse_bind_presence(args_context_t* ctx, uint64_t* presence, int* counts) {
+    if (!ctx) return FAIL;
+    ctx->bind_presence = presence;
+    ctx->bind_counts = counts;
+    return OK;
+}
+
+// copy value into buf as a NUL-terminated string, views are not terminated
+int value_to_buf_(const char* value, size_t len, char* buf, size_t size) {
+    if (!value || !len || len >= size) return FAIL;
+    memcpy(buf, value, len);
+    buf[len] = 0;
+    return OK;
+}
+
+int argparse_convert_int(void* dest, const char* value, size_t len) {
+    long v;
+    if (argparse_convert_long(&v, value, len) != OK || v < INT_MIN || v > INT_MAX) return FAIL;
+    *(int*)dest = (int)v;
+    return OK;
+}
+
+int argparse_convert_long(void* dest, const char* value, size_t len) {
+    char buf[32], *end;
+    if (value_to_buf_(value, len, buf, sizeof(buf)) != OK) return FAIL;
+    errno = 0;
+    long v = strtol(buf, &end, 0);
+    if (errno || *end) return FAIL;
+    *(long*)dest = v;
+    return OK;
+}
+
+int argparse_convert_double(void* dest, const char* value, size_t len) {
+    char buf[64], *end;
+    if (value_to_buf_(value, len, buf, sizeof(buf)) != OK) return FAIL;
+    errno = 0;
+    double v = strtod(buf, &end);
+    if (errno || *end) return FAIL;
+    *(double*)dest = v;
+    return OK;
+}
+
+int argparse_convert_string(void* dest, const char* value, size_t len) {
+    (void)len;
+    if (!value) return FAIL;
+    *(const char**)dest = value;
+    return OK;
+}
+
+int argparse_convert_flag(void* dest, const char* value, size_t len) {
+    static const char* const names[] = { "0", "false", "no", "off", "1", "true", "yes", "on" };
+    if (!value) {
+        *(int*)dest = 1;
+        return OK;
+    }
+    for (int i=0; i<8; i++) {
+        if (strlen(names[i]) == len && !strncmp(names[i], value, len)) {
+            *(int*)dest = i >= 4;
+            return OK;
+        }
+    }
+    return FAIL;
+}
+
+int argparse_convert_count(void* dest, const char* value, size_t len) {
+    (void)value;
+    (void)len;
+    ++*(int*)dest;
+    return OK;
+}
+
+int add_parameter_with_args(args_context_t* ctx, const char* long_term, char short_term,
+                  const char* description, int minc, int maxc, int required,
+                  void (*process)(args_context_t* ctx, int parac, const char** parav)) {
+    return add_parameter_with_args_(ctx, long_term, short_term, description, minc, maxc, required, process, 0, 0);
+}
+
+int argparse_add_parameter_directive(args_context_t* ctx, const char* long_term, char short_term,
                                      const char* description,  int required, void (*process)(args_context_t* ctx, int parac, const char** parav)) {
     return add_parameter_with_args_(ctx, long_term, short_term, description, 0, PARAMETER_ARGS_COUNT_NO_LIMIT, required,
                                     process, 1, 0);
@@ -509,7 +1635,14 @@ int argparse_add_parameter_short_term_with_args(args_context_t* ctx, char short_
         description, minc, maxc, required, process);
 }
 
+// a directive, so the flag itself arrives in parav[0] and --help=pattern searches instead
 void argparse_default_help_callback_(args_context_t* ctx, int parac, const char** parav) {
+    const char* pattern = parac > 0 && parav && parav[0] ? strchr(parav[0], '=') : NULL;
+    if (pattern && pattern[1]) {
+        if (argparse_print_help_matching(ctx, pattern + 1) == 0)
+            fprintf(ctx->output_file, "no option matches '%s'\n", pattern + 1);
+        exit(0);
+    }
     argparse_print_help_usage(ctx, "test", NULL, NULL);
     exit(0);
 }
@@ -517,8 +1650,7 @@ void argparse_default_help_callback_(args_context_t* ctx, int parac, const char*
 int argparse_add_help_parameter(args_context_t* ctx, const char* program_name, const char* description) {
     if (!ctx) return FAIL;
     if (!description) description = "Print this help message and exit";
-    argparse_add_parameter(ctx, "help", 'h', description, 0, 0, 0, argparse_default_help_callback_);
-    return OK;
+    return add_parameter_with_args_(ctx, "help", 'h', description, 0, 0, 0, argparse_default_help_callback_, 1, 0);
 }
 
 int argparse_set_error_handle(args_context_t* ctx, int (*hnd)(const char* __msg)) {
@@ -527,66 +1659,395 @@ int argparse_set_error_handle(args_context_t* ctx, int (*hnd)(const char* __msg)
     return OK;
 }
 
-#define PARSEARG_REPORT_ERROR(msg, ...)   do { \
-    char error_msg_buf[256];                   \
-    sprintf(error_msg_buf, msg, ##__VA_ARGS__);\
-    if (ctx->error_handle) {\
-        ctx->error_handle(error_msg_buf);                                \
-        return FAIL;\
-    }\
-} while (0)
+int argparse_set_error_handle_ex(args_context_t* ctx,
+                                 int (*hnd)(args_context_t* ctx, const argparse_error_t* err, void* user), void* user) {
+    if (!ctx) return FAIL;
+    ctx->error_handle_ex = hnd;
+    ctx->error_handle_user = user;
+    return OK;
+}
+
+int argparse_set_collect_errors(args_context_t* ctx, int enable) {
+    if (!ctx) return FAIL;
+    ctx->collect_errors = enable;
+    return OK;
+}
+
+int argparse_set_deferred_actions(args_context_t* ctx, int enable) {
+    if (!ctx) return FAIL;
+    ctx->deferred_actions = enable;
+    return OK;
+}
 
-arg_info_t* get_parameter_from_graph(args_context_t* ctx, const char* arg) {
-    const char * __a = arg;
+int argparse_get_action_order(args_context_t* ctx, int* _out_ids, int max_count) {
+    if (!ctx) return 0;
+    for (int i=0; _out_ids && i<ctx->action_count && i<max_count; i++)
+        _out_ids[i] = ctx->actions[i].arginfo->id;
+    return ctx->action_count;
+}
+
+const argparse_error_t* argparse_get_errors(args_context_t* ctx, int* _out_count) {
     if (!ctx) return NULL;
-    ctx_node_t* node = ctx->ctx_graph->head;
-    for (; *arg && *arg != '='; ++arg) {
-        int index = valarray_el_index_of(node->children, *arg);
-        if (index >= 0) {
-            assert(index < node->children->size);
-            node = *valarray_get(node->children, index);
+    if (_out_count) *_out_count = ctx->error_count;
+    return ctx->error_count ? ctx->errors : NULL;
+}
+
+arg_info_t* get_arg_info_by_id(args_context_t* ctx, int id) {
+    // inherited ids are below id_base of the context
+    while (ctx && id < ctx->id_base)
+        ctx = ctx->parent;
+    if (!ctx) return NULL;
+    // args may be sorted, ids stay in registration order
+    for (size_t i=0; i<ctx->args->size; i++) {
+        arg_info_t* _a = ctx->args->data[i];
+        if (_a->id == id)
+            return _a;
+    }
+    return NULL;
+}
+
+const char* arg_info_to_string(arg_info_t* arg);
+
+// append to buf after w chars, w keeps counting past the end like snprintf
+#define FORMAT_APPEND_(fmt, ...) \
+    (w += snprintf(buf + ((size_t)w < size ? (size_t)w : size), (size_t)w < size ? size - (size_t)w : 0, fmt, ##__VA_ARGS__))
+
+int argparse_format_error(args_context_t* ctx, const argparse_error_t* err, char* buf, size_t size) {
+    if (!ctx || !err) return -1;
+    arg_info_t* _a = err->option >= 0 ? get_arg_info_by_id(ctx, err->option) : NULL;
+    const char* name = _a ? arg_info_to_string(_a) : "";
+    int text_len = err->text_len >= 0 ? err->text_len : (err->text ? (int)strlen(err->text) : 0);
+    const char* text = err->text ? err->text : "";
+    switch (err->code) {
+        case ARGPARSE_ERROR_UNKNOWN_OPTION:
+            return snprintf(buf, size, "unknown option --%.*s", text_len, text);
+        case ARGPARSE_ERROR_AMBIGUOUS_OPTION:
+            return snprintf(buf, size, "--%.*s is ambiguous", text_len, text);
+        case ARGPARSE_ERROR_MISSING_PARAMETER:
+            if (_a && _a->help->err_msg)
+                return snprintf(buf, size, "--%s: %s", name, _a->help->err_msg);
+            return snprintf(buf, size, "at least %d additional arguments should provided for --%s",
+                            _a ? _a->min_parameter_count : 0, name);
+        case ARGPARSE_ERROR_UNKNOWN_POSITIONAL:
+            return snprintf(buf, size, "unknown positional arg: %.*s", text_len, text);
+        case ARGPARSE_ERROR_TOO_FEW_POSITIONAL:
+            return snprintf(buf, size, "%d positional args provided, expected at least %d positional args",
+                            err->count, ctx->positional_minc);
+        case ARGPARSE_ERROR_MISSING_REQUIRED:
+            return snprintf(buf, size, "missing required arg: --%s", name);
+        case ARGPARSE_ERROR_UNTERMINATED_QUOTE:
+            return snprintf(buf, size, "unterminated quote in command line");
+        case ARGPARSE_ERROR_MUTUALLY_EXCLUSIVE:
+        case ARGPARSE_ERROR_REQUIRES: {
+            // arg_info_to_string() shares one buffer for short terms, print the names one by one
+            int w = snprintf(buf, size, "--%s %s --", name,
+                             err->code == ARGPARSE_ERROR_REQUIRES ? "requires" : "cannot be used with");
+            arg_info_t* _b = get_arg_info_by_id(ctx, err->count);
+            FORMAT_APPEND_("%s", _b ? arg_info_to_string(_b) : "");
+            return w;
         }
-        else {
-            // no such parameter
-            return NULL;
+        case ARGPARSE_ERROR_INVALID_VALUE:
+            return snprintf(buf, size, "invalid value '%.*s' for --%s", text_len, text, name);
+        case ARGPARSE_ERROR_UNEXPECTED_VALUE:
+            return snprintf(buf, size, "--%s does not take a value '%.*s'", name, text_len, text);
+        case ARGPARSE_ERROR_TASK_FAILED:
+            return snprintf(buf, size, "processing positional arg #%d failed: %.*s", err->count, text_len, text);
+        case ARGPARSE_ERROR_INVALID_CHOICE:
+        case ARGPARSE_ERROR_AMBIGUOUS_CHOICE: {
+            int w = snprintf(buf, size, "%s choice '%.*s' for --%s (choose from",
+                             err->code == ARGPARSE_ERROR_INVALID_CHOICE ? "invalid" : "ambiguous", text_len, text, name);
+            for (int i=0; _a && i<_a->help->choice_count; i++)
+                FORMAT_APPEND_("%s %s", i ? "," : "", _a->help->choice_names[i]);
+            FORMAT_APPEND_(")");
+            return w;
         }
-    }
-    // If this flag can become an end
-    if (node->arg_info) {
-        goto return_an_arg_info;
-    }
-    // returns the final node
-    // if the node is not final node
-    if (node->children->size// if has children node
-        && arg[1] // if is not short term
-        ) {
-        // try to find the final node
-        while (1) {
-            if (node->children->size == 0) {
-                // reach the final node
-                break;
+        case ARGPARSE_ERROR_AT_LEAST_ONE: {
+            if (err->count < 0 || (size_t)err->count >= ctx->constraints->size)
+                return snprintf(buf, size, "missing one of required args");
+            constraint_t* c = ctx->constraints->data[err->count];
+            int w = snprintf(buf, size, "at least one of");
+            for (int i=0; i<c->count; i++) {
+                arg_info_t* _b = get_arg_info_by_id(ctx, c->options[i]);
+                FORMAT_APPEND_("%s --%s", i ? "," : "", _b ? arg_info_to_string(_b) : "");
             }
-            else if (node->children->size == 1) {
-                // walk to the next node
-                node = *valarray_get(node->children, 0);
+            FORMAT_APPEND_(" is required");
+            return w;
+        }
+        case ARGPARSE_ERROR_OCCURRENCE: {
+            int minc = 0, maxc = PARAMETER_ARGS_COUNT_NO_LIMIT;
+            for (size_t i=0; i<ctx->constraints->size; i++) {
+                constraint_t* c = ctx->constraints->data[i];
+                if (c->type == ARGPARSE_CONSTRAINT_OCCURRENCE && c->options[0] == err->option) {
+                    minc = c->minc;
+                    maxc = c->maxc;
+                }
             }
-            else {
-                // has one more children, report error for ambiguous flags
-                PARSEARG_REPORT_ERROR("--%s is ambiguous", __a);
-                return NULL;
+            return snprintf(buf, size, "--%s occurs %d times, expected %d to %d times", name, err->count, minc, maxc);
+        }
+        default:
+            return snprintf(buf, size, "unknown error");
+    }
+}
+
+// =================================================================================
+// parse trace
+
+#define TRACE_AT_TOKEN (-2) // argv index of the token being parsed
+
+/* Ring buffer of parse events */
+typedef struct trace_ring {
+    argparse_trace_event_t* events;
+    uint64_t head;      // count of events ever recorded
+    uint32_t mask;      // capacity - 1
+    int argv_index;     // token being parsed, for events deeper than the parse loop
+} trace_ring_t;
+
+void trace_record_(args_context_t* ctx, int type, int argv_index, int id, int data) {
+    trace_ring_t* t = ctx->trace;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (type == ARGPARSE_TRACE_PARSE || type == ARGPARSE_TRACE_TOKEN)
+        t->argv_index = argv_index;
+    else if (argv_index == TRACE_AT_TOKEN)
+        argv_index = t->argv_index;
+    argparse_trace_event_t* e = &t->events[t->head++ & t->mask];
+    e->time_ns = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    e->type = type;
+    e->argv_index = argv_index;
+    e->id = id;
+    e->data = data;
+}
+
+// the only cost while disabled is the branch
+#define TRACE(_ctx, _type, _argv_index, _id, _data) do { \
+    if ((_ctx)->trace) \
+        trace_record_(_ctx, _type, _argv_index, _id, _data); \
+} while (0)
+
+int argparse_set_trace(args_context_t* ctx, int capacity) {
+    if (!ctx || capacity < 0) return FAIL;
+    if (ctx->trace) {
+        ARGPARSE_FREE(&ctx->allocator, ctx->trace);
+        ctx->trace = NULL;
+    }
+    if (!capacity) return OK;
+    uint32_t n = 1;
+    while (n < (uint32_t)capacity) n <<= 1;
+    trace_ring_t* t = (trace_ring_t*)ARGPARSE_MALLOC(&ctx->allocator, sizeof(trace_ring_t) + n * sizeof(argparse_trace_event_t));
+    if (!t) return FAIL;
+    t->events = (argparse_trace_event_t*)(t + 1);
+    t->head = 0;
+    t->mask = n - 1;
+    t->argv_index = -1;
+    ctx->trace = t;
+    return OK;
+}
+
+int argparse_get_trace(args_context_t* ctx, argparse_trace_event_t* _out_e, int max_count) {
+    if (!ctx || !ctx->trace) return 0;
+    trace_ring_t* t = ctx->trace;
+    uint64_t count = t->head < (uint64_t)t->mask + 1 ? t->head : (uint64_t)t->mask + 1;
+    uint64_t n = _out_e && max_count > 0 ? (count < (uint64_t)max_count ? count : (uint64_t)max_count) : 0;
+    for (uint64_t i=0; i<n; i++)
+        _out_e[i] = t->events[(t->head - n + i) & t->mask];
+    return (int)count;
+}
+
+int argparse_dump_trace(args_context_t* ctx, FILE* out) {
+    static const char* types[] = { "parse", "token", "node", "abbrev", "value", "enter", "exit", "error" };
+    static const char* kinds[] = { "?", "value", "short", "long", "long=value", "separator" };
+    if (!ctx || !out) return FAIL;
+    if (!ctx->trace) return OK;
+    trace_ring_t* t = ctx->trace;
+    int count = argparse_get_trace(ctx, NULL, 0);
+    uint64_t first = count ? t->events[(t->head - count) & t->mask].time_ns : 0;
+    for (int i=0; i<count; i++) {
+        argparse_trace_event_t* e = &t->events[(t->head - count + i) & t->mask];
+        fprintf(out, "%12.3fus %-6s", (double)(e->time_ns - first) / 1000.0,
+                e->type >= 0 && e->type <= ARGPARSE_TRACE_ERROR ? types[e->type] : "?");
+        if (e->argv_index >= 0)
+            fprintf(out, " argv[%d]", e->argv_index);
+        if (e->id >= 0) {
+            arg_info_t* _a = get_arg_info_by_id(ctx, e->id);
+            fprintf(out, " --%s", _a ? arg_info_to_string(_a) : "(removed)");
+        }
+        switch (e->type) {
+            case ARGPARSE_TRACE_PARSE:          fprintf(out, " argc=%d", e->data); break;
+            case ARGPARSE_TRACE_TOKEN:          fprintf(out, " %s", e->data >= ARGPARSE_TOKEN_VALUE && e->data <= ARGPARSE_TOKEN_SEPARATOR ? kinds[e->data] : "?"); break;
+            case ARGPARSE_TRACE_NODE:           e->data >= 0 ? fprintf(out, " depth=%d", e->data) : fprintf(out, " not found"); break;
+            case ARGPARSE_TRACE_ABBREV:         fprintf(out, " from %d chars", e->data); break;
+            case ARGPARSE_TRACE_VALUE:          fprintf(out, " #%d", e->data); break;
+            case ARGPARSE_TRACE_CALLBACK_ENTER: fprintf(out, " parac=%d", e->data); break;
+            case ARGPARSE_TRACE_ERROR:          fprintf(out, " code=%d", e->data); break;
+            default: break;
+        }
+        fprintf(out, "\n");
+    }
+    return OK;
+}
+
+// =================================================================================
+// adaptive lookup
+
+#define PROFILE_PATH_MAX 256
+
+// graphs of versions of a spec are shared with readers on other threads, they never adapt,
+// neither do graphs of contexts with derived ones, which look names up through them
+#define ADAPTIVE_CHECK(_ctx) do { \
+    if ((_ctx)->spec || (_ctx)->version) { \
+        LOGE("lookup order of a spec cannot adapt"); \
+        return FAIL; \
+    } \
+    if ((_ctx)->child_count) { \
+        LOGE("lookup order of a context with %d derived contexts cannot adapt", (_ctx)->child_count); \
+        return FAIL; \
+    } \
+} while (0)
+
+int argparse_set_adaptive_lookup(args_context_t* ctx, int enable) {
+    if (!ctx) return FAIL;
+    ADAPTIVE_CHECK(ctx);
+    ctx->ctx_graph->adaptive = enable != 0;
+    return OK;
+}
+
+// write "<hits> <path>" for every node of the subtree taken at least once
+void profile_write_(ctx_node_t* node, char* path, int depth, FILE* out) {
+    if (depth >= PROFILE_PATH_MAX - 1)
+        return;
+    for (size_t i=0; i<node->children->size; i++) {
+        ctx_node_t* child = *valarray_get(node->children, i);
+        if (!child->hits)
+            continue; // a child is never taken more often than its parent
+        path[depth] = child->ch;
+        path[depth + 1] = 0;
+        fprintf(out, "%u %s\n", child->hits, path);
+        profile_write_(child, path, depth + 1, out);
+    }
+}
+
+int argparse_save_lookup_profile(args_context_t* ctx, const char* path) {
+    if (!ctx || !path) return FAIL;
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        LOGE("cannot write profile %s: %s", path, strerror(errno));
+        return FAIL;
+    }
+    char buf[PROFILE_PATH_MAX];
+    profile_write_(ctx->ctx_graph->head, buf, 0, out);
+    return fclose(out) == 0 ? OK : FAIL;
+}
+
+int argparse_load_lookup_profile(args_context_t* ctx, const char* path) {
+    if (!ctx || !path) return FAIL;
+    ADAPTIVE_CHECK(ctx);
+    FILE* in = fopen(path, "r");
+    if (!in) return FAIL; // no profile yet is the normal first run
+    char line[PROFILE_PATH_MAX + 32];
+    while (fgets(line, sizeof(line), in)) {
+        char* s;
+        unsigned long hits = strtoul(line, &s, 10);
+        if (s == line || *s != ' ')
+            continue;
+        s++;
+        s[strcspn(s, "\n")] = 0;
+        // names removed since the profile was written are skipped
+        ctx_node_t* node = ctx->ctx_graph->head;
+        for (; *s && node; s++) {
+            int index = valarray_el_index_of(node->children, *s);
+            node = index < 0 ? NULL : *valarray_get(node->children, index);
+        }
+        if (node && node != ctx->ctx_graph->head)
+            node->hits = hits > UINT32_MAX - node->hits ? UINT32_MAX : node->hits + (uint32_t)hits;
+    }
+    fclose(in);
+    ctx_node_sort_by_hits_(ctx->ctx_graph->head);
+    return OK;
+}
+
+/// Record an error and notify handlers, returns 1 if parsing should stop now
+int argparse_report_error_(args_context_t* ctx, argparse_error_code_t code, int argv_index, arg_info_t* arginfo,
+                           int offset, const char* text, int text_len, int count) {
+    TRACE(ctx, ARGPARSE_TRACE_ERROR, argv_index, arginfo ? arginfo->id : -1, code);
+    // keep only the first error unless collecting all
+    if (ctx->collect_errors || ctx->error_count == 0) {
+        if (ctx->error_count + 1 > ctx->error_capacity) {
+            int capacity = ctx->error_capacity ? ctx->error_capacity * 2 : 4;
+            argparse_error_t* _new = ARGPARSE_REALLOC(&ctx->allocator, ctx->errors, capacity * sizeof(argparse_error_t));
+            if (!_new) {
+                LOGE("allocate memory for errors failed");
+                return 1;
             }
+            ctx->errors = _new;
+            ctx->error_capacity = capacity;
+        }
+        argparse_error_t* err = &ctx->errors[ctx->error_count++];
+        err->code = code;
+        err->argv_index = argv_index;
+        err->option = arginfo ? arginfo->id : -1;
+        err->offset = offset;
+        err->text = text;
+        err->text_len = text_len;
+        err->count = count;
+        if (ctx->error_handle_ex) {
+            ctx->error_handle_ex(ctx, err, ctx->error_handle_user);
+        }
+        else if (ctx->error_handle) {
+            // only the legacy handler needs a message
+            char error_msg_buf[256];
+            argparse_format_error(ctx, err, error_msg_buf, sizeof(error_msg_buf));
+            ctx->error_handle(error_msg_buf);
         }
     }
+    if (ctx->collect_errors)
+        return 0;
+    return ctx->error_handle_ex || ctx->error_handle;
+}
 
-    if (node->_arg_sign == ACANE_SIGN) {
-        goto return_an_arg_info;
+#define PARSEARG_REPORT_ERROR(_code, _argv_index, _arginfo, _offset, _text, _text_len, _count) do { \
+    if (argparse_report_error_(ctx, _code, _argv_index, _arginfo, _offset, _text, _text_len, _count)) \
+        return FAIL; \
+} while (0)
+
+// find a parameter in the context, then in its ancestors (the nearest wins, also for abbreviations)
+// only the own graph adapts, ancestors are shared read-only with other derived contexts
+ctx_node_t* find_node_inherited_(args_context_t* ctx, const char* arg, size_t len, int allow_abbrev, int adapt,
+                                 int* _out_ambiguous) {
+    for (args_context_t* c = ctx; c; c = c->parent) {
+        ctx_node_t* node = ctx_graph_find_node_(c->ctx_graph, arg, len, allow_abbrev, adapt && c == ctx, _out_ambiguous);
+        if (node || *_out_ambiguous)
+            return node;
     }
-    // no arg bound to this node
     return NULL;
+}
+
+// trace a lookup of the parse loop, depth of a parameter follows from the id_base of each context
+void trace_lookup_(args_context_t* ctx, arg_info_t* _a, size_t len) {
+    if (!_a) {
+        trace_record_(ctx, ARGPARSE_TRACE_NODE, TRACE_AT_TOKEN, -1, -1);
+        return;
+    }
+    int depth = 0;
+    for (args_context_t* c = ctx; c && _a->id < c->id_base; c = c->parent)
+        depth++;
+    trace_record_(ctx, ARGPARSE_TRACE_NODE, TRACE_AT_TOKEN, _a->id, depth);
+    if (_a->long_term && len > 1 && strlen(_a->long_term) != len)
+        trace_record_(ctx, ARGPARSE_TRACE_ABBREV, TRACE_AT_TOKEN, _a->id, (int)len);
+}
 
-return_an_arg_info:
-    node->arg_info->_requirement_satisfied_sign = ACANE_SIGN;
-    node->arg_info->result_item->count++;
+arg_info_t* get_parameter_from_graph(args_context_t* ctx, const char* arg, size_t len, int allow_abbrev, int* _out_ambiguous) {
+    if (!ctx) return NULL;
+    ctx_node_t* node = find_node_inherited_(ctx, arg, len, allow_abbrev, ctx->ctx_graph->adaptive && !ctx->child_count,
+                                             _out_ambiguous);
+    if (ctx->trace)
+        trace_lookup_(ctx, node ? node->arg_info : NULL, len);
+    if (!node) return NULL;
+    BITSET_SET(ctx->seen, node->arg_info->id);
+    RESULT_ITEM(ctx, node->arg_info)->count++;
+    if (ctx->bind_presence)
+        BITSET_SET(ctx->bind_presence, node->arg_info->id);
+    if (ctx->bind_counts)
+        ctx->bind_counts[node->arg_info->id]++;
     return node->arg_info;
 }
 
@@ -602,51 +2063,95 @@ const char* arg_info_to_string(arg_info_t* arg) {
 }
 
 
-parse_result_item_t* argparse_parse_result_item_init() {
-    parse_result_item_t* _r = (parse_result_item_t*)malloc(sizeof(parse_result_item_t));
-    if (!_r) return NULL;
-    valarray_init(&_r->args);
+// values are allocated with the first one, most parameters are absent from a parse
+void argparse_parse_result_item_init(parse_result_item_t* _r, arg_info_t* arginfo) {
+    _r->arginfo = arginfo;
+    _r->args = NULL;
+    _r->lens = NULL;
     _r->count = 0;
-    return _r;
+    _r->choice = -1;
+    _r->action_slot = 0;
 }
 
 void argparse_parse_result_item_deinit(parse_result_item_t* _r) {
-    if (!_r) return;
-    valarray_deinit(_r->args);
-    free(_r);
+    if (_r->args)
+        valarray_deinit(_r->args);
+    if (_r->lens)
+        valarray_deinit(_r->lens);
 }
 
 
 parse_result_t* argparse_parse_result_init(args_context_t* ctx) {
-    parse_result_t* _r = (parse_result_t*) malloc(sizeof(parse_result_t*));
+    parse_result_t* _r = (parse_result_t*) ARGPARSE_MALLOC(&ctx->allocator, sizeof(parse_result_t));
     if (!_r) return NULL;
-    _r->keep_this_obj = 0;
-    valarray_init(&_r->args);
-    // assign current result to arg_info object
-    for (int i=0; i<ctx->args->size; i++) {
-        arg_info_t* _a = ctx->args->data[i];
-        parse_result_item_t* ri = argparse_parse_result_item_init();
-        _a->result_item = ri;
-        ri->arginfo = _a;
-        valarray_push_back(_r->args, (void*) ri);
+    _r->allocator = ctx->allocator;
+    // one item per parameter id, including inherited parameters
+    _r->item_count = args_count_(ctx);
+    _r->items = (parse_result_item_t*)ARGPARSE_MALLOC(&_r->allocator, (_r->item_count ? _r->item_count : 1)
+                                                                      * sizeof(parse_result_item_t));
+    if (!_r->items) {
+        ARGPARSE_FREE(&ctx->allocator, _r);
+        return NULL;
+    }
+    for (int id=0; id<_r->item_count; id++)
+        argparse_parse_result_item_init(&_r->items[id], ctx->args_by_id[id]);
+    valarray_init(&_r->positionals, &_r->allocator);
+    _r->positional_lens = NULL;
+    _r->views = 0;
+    _r->bytes = sizeof(parse_result_t) + (_r->item_count ? _r->item_count : 1) * sizeof(parse_result_item_t)
+                + VALARRAY_BYTES(_r->positionals);
+    _r->snapshot_args = NULL;
+    _r->mapping = NULL;
+    _r->mapping_size = 0;
+    return _r;
+}
+
+// reuse a result no longer owned by the caller, so repeated parses don't allocate
+parse_result_t* argparse_parse_result_recycle(args_context_t* ctx, parse_result_t* _r) {
+    if (!_r) return argparse_parse_result_init(ctx);
+    if (_r->item_count != args_count_(ctx)) {
+        argparse_parse_result_deinit(_r);
+        return argparse_parse_result_init(ctx);
     }
-    assert(_r->args->size == ctx->args->size);
+    for (int i=0; i<_r->item_count; i++) {
+        parse_result_item_t* ri = &_r->items[i];
+        ri->count = 0;
+        if (ri->args)
+            ri->args->size = 0;
+        if (ri->lens)
+            ri->lens->size = 0;
+        ri->choice = -1;
+        ri->arginfo = ctx->args_by_id[i];
+    }
+    _r->positionals->size = 0;
+    if (_r->positional_lens)
+        _r->positional_lens->size = 0;
     return _r;
 }
 
 void argparse_parse_result_deinit(parse_result_t* _r) {
     if (!_r) return;
-    for (int i=0; i<_r->args->size; i++) {
-        argparse_parse_result_item_deinit((parse_result_item_t*)_r->args->data[i]);
-    }
-    valarray_deinit(_r->args);
-    free(_r);
+    argparse_allocator_t allocator = _r->allocator;
+    for (int i=0; i<_r->item_count; i++)
+        argparse_parse_result_item_deinit(&_r->items[i]);
+    if (_r->items)
+        ARGPARSE_FREE(&allocator, _r->items);
+    valarray_deinit(_r->positionals);
+    if (_r->positional_lens)
+        valarray_deinit(_r->positional_lens);
+    if (_r->snapshot_args)
+        ARGPARSE_FREE(&allocator, _r->snapshot_args);
+#ifndef ARGPARSE_NO_MMAP
+    if (_r->mapping)
+        munmap(_r->mapping, _r->mapping_size);
+#endif
+    ARGPARSE_FREE(&allocator, _r);
 }
 
 parse_result_t* argparse_get_last_parse_result(args_context_t* ctx) {
     if (!ctx) return NULL;
     if (!ctx->last_result) return NULL;
-    ctx->last_result->keep_this_obj = 1; // transfer memory control to callee
+    ctx->keep_last_result = 1; // transfer memory control to callee
     return ctx->last_result;
 }
 
@@ -654,9 +2159,10 @@ int argparse_get_parsed_arg(parse_result_t* _r, const char* argname, parsed_argu
     if (!_r)   return FAIL;
     if (!argname || !*argname) return FAIL;
     parse_result_item_t* item;
-    for (int i=0; i<_r->args->size; i++) {
-        item = (parse_result_item_t*)_r->args->data[i];
+    for (int i=0; i<_r->item_count; i++) {
+        item = &_r->items[i];
         // is short term
+        if (!item->arginfo) continue; // removed parameter
         if (!argname[1] && item->arginfo->short_term) {
             int short_term = *argname;
             if (short_term == item->arginfo->short_term)
@@ -675,8 +2181,8 @@ return_parsed_arg:
     LOG(" got arginfo --%s", argname);
     assert(item);
     _out_a->count = item->count;
-    _out_a->parac = item->args->size;
-    _out_a->parav = (const char**) item->args->data;
+    _out_a->parac = item->args ? (int)item->args->size : 0;
+    _out_a->parav = item->args ? (const char**) item->args->data : NULL;
     return OK;
 }
 
@@ -687,94 +2193,675 @@ int argparse_count(parse_result_t* _r, const char* argname) {
     return _a.count;
 }
 
-void process_if_no_args(args_context_t* ctx) {
+const char** argparse_get_positionals(parse_result_t* _r, int* _out_count) {
+    if (!_r) return NULL;
+    if (_out_count) *_out_count = (int)_r->positionals->size;
+    return (const char**)_r->positionals->data;
+}
+
+parse_result_item_t* find_result_item_(parse_result_t* _r, const char* argname) {
+    if (!_r || !argname || !*argname) return NULL;
+    for (int i=0; i<_r->item_count; i++) {
+        parse_result_item_t* item = &_r->items[i];
+        if (!item->arginfo) continue; // removed parameter
+        if ((!argname[1] && item->arginfo->short_term == *argname)
+            || (argname[1] && item->arginfo->long_term && !strcmp(argname, item->arginfo->long_term)))
+            return item;
+    }
+    return NULL;
+}
+
+int argparse_get_choice(parse_result_t* _r, const char* argname) {
+    parse_result_item_t* item = find_result_item_(_r, argname);
+    return item ? item->choice : -1;
+}
+
+// length of i-th value, recorded for views and measured for argv
+size_t value_len_(parse_result_t* _r, valarray_t* values, valarray_t* lens, int i) {
+    return _r->views ? (size_t)(uintptr_t)lens->data[i] : strlen(values->data[i]);
+}
+
+// fill views of values, lengths are recorded for views and measured for argv
+int fill_views_(parse_result_t* _r, valarray_t* values, valarray_t* lens, argparse_view_t* _out_v, int max_count) {
+    if (!values) return 0;
+    for (int i=0; _out_v && (size_t)i<values->size && i<max_count; i++) {
+        _out_v[i].ptr = values->data[i];
+        _out_v[i].len = value_len_(_r, values, lens, i);
+    }
+    return (int)values->size;
+}
+
+int argparse_get_parsed_views(parse_result_t* _r, const char* argname, argparse_view_t* _out_v, int max_count) {
+    parse_result_item_t* item = find_result_item_(_r, argname);
+    if (!item) return -1;
+    return fill_views_(_r, item->args, item->lens, _out_v, max_count);
+}
+
+int argparse_get_positional_views(parse_result_t* _r, argparse_view_t* _out_v, int max_count) {
+    if (!_r) return -1;
+    return fill_views_(_r, _r->positionals, _r->positional_lens, _out_v, max_count);
+}
+
+int argparse_get_parameter_id(args_context_t* ctx, const char* argname) {
+    if (!ctx || !argname || !*argname) return -1;
+    int ambiguous;
+    ctx_node_t* node = find_node_inherited_(ctx, argname, strlen(argname), 0, 0, &ambiguous);
+    if (!node) return -1;
+    return node->arg_info->id;
+}
+
+// run process of a parameter, or queue it if actions are deferred
+void invoke_process_(args_context_t* ctx, arg_info_t* _a, int parac, const char** parav) {
+    // values of views are not NUL-terminated, callbacks are not called for them
+    if (!_a->process || ctx->parsing_views) return;
+    if (!ctx->deferred_actions) {
+        TRACE(ctx, ARGPARSE_TRACE_CALLBACK_ENTER, TRACE_AT_TOKEN, _a->id, parac);
+        _a->process(ctx, parac, parav);
+        TRACE(ctx, ARGPARSE_TRACE_CALLBACK_EXIT, TRACE_AT_TOKEN, _a->id, 0);
+        return;
+    }
+    // repeated parameter, only the last values are kept
+    parse_result_item_t* ri = RESULT_ITEM(ctx, _a);
+    if (ri->action_slot < ctx->action_count && ctx->actions[ri->action_slot].arginfo == _a) {
+        ctx->actions[ri->action_slot].parac = parac;
+        ctx->actions[ri->action_slot].parav = parav;
+        return;
+    }
+    if (ctx->action_count + 1 > ctx->action_capacity) {
+        int capacity = ctx->action_capacity ? ctx->action_capacity * 2 : 8;
+        action_t* _new = ARGPARSE_REALLOC(&ctx->allocator, ctx->actions, capacity * sizeof(action_t));
+        if (!_new) {
+            LOGE("allocate memory for actions failed");
+            return;
+        }
+        ctx->actions = _new;
+        ctx->action_capacity = capacity;
+    }
+    ri->action_slot = ctx->action_count;
+    action_t* act = &ctx->actions[ctx->action_count++];
+    act->arginfo = _a;
+    act->parac = parac;
+    act->parav = parav;
+}
+
+// order queued actions by priority (stable, so equal priorities keep argv order)
+void sort_actions_(args_context_t* ctx) {
+    for (int i=1; i<ctx->action_count; i++) {
+        action_t act = ctx->actions[i];
+        int j = i;
+        for (; j > 0 && ctx->actions[j-1].arginfo->priority < act.arginfo->priority; j--)
+            ctx->actions[j] = ctx->actions[j-1];
+        ctx->actions[j] = act;
+    }
+}
+
+// run jobs on the thread pool, or one by one on the calling thread
+void run_jobs_(args_context_t* ctx, const pool_job_t* jobs, int njobs, const int* items, int* status,
+               pool_run_item_t run_item) {
+#ifndef ARGPARSE_NO_THREADS
+    if (ctx->pool && njobs > 1 && pool_run_(ctx->pool, ctx, jobs, njobs, items, status, run_item) == OK)
+        return;
+#endif
+    for (int j=0; j<njobs; j++)
+        for (int k=jobs[j].begin; k<jobs[j].end; k++)
+            status[items[k]] = run_item(ctx, items[k]);
+}
+
+int run_action_item_(args_context_t* ctx, int item) {
+    action_t* act = &ctx->actions[item];
+    act->arginfo->process(ctx, act->parac, act->parav);
+    return OK;
+}
+
+void run_actions_(args_context_t* ctx) {
+    int n = ctx->action_count;
+    pool_job_t* jobs = NULL;
+    if (ctx->parallel_actions && ctx->pool && n > 1) {
+        jobs = (pool_job_t*)ARGPARSE_MALLOC(&ctx->allocator, n * (sizeof(pool_job_t) + 2 * sizeof(int)));
+        if (!jobs)
+            LOGE("allocate memory for parallel actions failed, run in order");
+    }
+    if (!jobs) {
+        for (int i=0; i<n; i++) {
+            TRACE(ctx, ARGPARSE_TRACE_CALLBACK_ENTER, -1, ctx->actions[i].arginfo->id, ctx->actions[i].parac);
+            run_action_item_(ctx, i);
+            TRACE(ctx, ARGPARSE_TRACE_CALLBACK_EXIT, -1, ctx->actions[i].arginfo->id, 0);
+        }
+        return;
+    }
+    int* items = (int*)(jobs + n);
+    int* status = items + n;
+    for (int i=0; i<n; i++) {
+        items[i] = i;
+        jobs[i].begin = i;
+        jobs[i].end = i + 1;
+    }
+    // actions of the same priority run concurrently, priorities run one after another
+    for (int begin=0, end; begin<n; begin=end) {
+        for (end=begin+1; end<n && ctx->actions[end].arginfo->priority == ctx->actions[begin].arginfo->priority; end++);
+        run_jobs_(ctx, jobs + begin, end - begin, items, status, run_action_item_);
+    }
+    ARGPARSE_FREE(&ctx->allocator, jobs);
+}
+
+int run_positional_item_(args_context_t* ctx, int item) {
+    return ctx->positional_task(item, ctx->last_result->positionals->data[item], ctx->positional_task_user);
+}
+
+// stable bottom-up merge sort of items by keys[item]
+void sort_items_by_key_(int* items, int* tmp, const int* keys, int n) {
+    int* src = items;
+    int* dst = tmp;
+    for (int width=1; width<n; width*=2) {
+        for (int lo=0; lo<n; lo+=2*width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+            int a = lo, b = mid, k = lo;
+            while (a < mid && b < hi)
+                dst[k++] = keys[src[b]] < keys[src[a]] ? src[b++] : src[a++];
+            while (a < mid) dst[k++] = src[a++];
+            while (b < hi)  dst[k++] = src[b++];
+        }
+        int* t = src; src = dst; dst = t;
+    }
+    if (src != items)
+        memcpy(items, src, n * sizeof(int));
+}
+
+// run positional tasks after a successful parse, failures are reported as errors
+int run_positional_tasks_(args_context_t* ctx) {
+    valarray_t* pos = ctx->last_result->positionals;
+    int n = (int)pos->size;
+    if (!n) return OK;
+    // jobs, items, status, then lanes and sort buffer if ordered
+    size_t size = n * (sizeof(pool_job_t) + (ctx->positional_lane ? 4 : 2) * sizeof(int));
+    pool_job_t* jobs = (pool_job_t*)ARGPARSE_MALLOC(&ctx->allocator, size);
+    if (!jobs) {
+        LOGE("allocate memory for positional tasks failed");
+        return FAIL;
+    }
+    int* items = (int*)(jobs + n);
+    int* status = items + n;
+    int njobs = 0;
+    for (int i=0; i<n; i++)
+        items[i] = i;
+    if (ctx->positional_lane) {
+        int* lanes = status + n;
+        int* tmp = lanes + n;
+        for (int i=0; i<n; i++)
+            lanes[i] = ctx->positional_lane(i, pos->data[i], ctx->positional_task_user);
+        sort_items_by_key_(items, tmp, lanes, n);
+        // items of a lane form one job, so they run in order; negative lanes are unordered
+        for (int begin=0, end; begin<n; begin=end) {
+            end = begin + 1;
+            if (lanes[items[begin]] >= 0)
+                while (end < n && lanes[items[end]] == lanes[items[begin]]) end++;
+            jobs[njobs].begin = begin;
+            jobs[njobs++].end = end;
+        }
+    } else {
+        for (int i=0; i<n; i++) {
+            jobs[njobs].begin = i;
+            jobs[njobs++].end = i + 1;
+        }
+    }
+    run_jobs_(ctx, jobs, njobs, items, status, run_positional_item_);
+    int ret = OK;
+    for (int i=0; i<n; i++) {
+        if (status[i] == OK) continue;
+        ret = FAIL;
+        const char* arg = pos->data[i];
+        if (argparse_report_error_(ctx, ARGPARSE_ERROR_TASK_FAILED, -1, NULL, 0, arg, (int)strlen(arg), i))
+            break;
+    }
+    ARGPARSE_FREE(&ctx->allocator, jobs);
+    return ret;
+}
+
+int bind_value_(args_context_t* ctx, arg_info_t* _a, const char* value, size_t len, int argv_index, int offset);
+
+// returns FAIL if parsing should stop
+int process_if_no_args(args_context_t* ctx, int argv_index) {
     // process if no need args
     if (ctx->current_arg->max_parameter_count == 0) {
         LOG("   ctx->current_arg->max_parameter_count=%d", ctx->current_arg->max_parameter_count);
         LOG("do process for flag (no args):  %s", arg_info_to_string(ctx->current_arg));
-        if (ctx->current_arg->process)
-            ctx->current_arg->process(ctx, 0, NULL);
+        if (ctx->current_arg->bind_convert && bind_value_(ctx, ctx->current_arg, NULL, 0, argv_index, 0) != OK)
+            return FAIL;
+        invoke_process_(ctx, ctx->current_arg, 0, NULL);
         ctx->current_arg = NULL;
     }
+    return OK;
 }
 
+// a parameter with optional values given without any, e.g., --color, its converter gets NULL like a flag
+#define OPTIONAL_WITHOUT_VALUES(_a) ((_a) && (_a)->min_parameter_count == 0 && (_a)->max_parameter_count \
+                                     && ctx->current_addi_arg_count == 0)
+
 #define CHECK_ADDITIONAL_ARGS() do { \
     /* Check if last argument need additional argument */ \
     if (ctx->current_arg    /* has arg parsed */ \
         && ctx->current_arg->max_parameter_count != 0  /* has additional arg */ \
         && ctx->current_addi_arg_count < ctx->current_arg->min_parameter_count /* not all args present */ \
     ) {                              \
-        if (ctx->current_arg->err_msg) {                  \
-            PARSEARG_REPORT_ERROR("--%s: %s", arg_info_to_string(ctx->current_arg), ctx->current_arg->err_msg);                             \
-        }                             \
-        else {                       \
-            PARSEARG_REPORT_ERROR("at least %d additional arguments should provided for --%s",\
-                                  ctx->current_arg->min_parameter_count, arg_info_to_string(ctx->current_arg)); \
-        }       \
+        PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_MISSING_PARAMETER, __current_arg_idx, ctx->current_arg, 0, NULL, 0, 0); \
     }                                    \
 } while (0)
 
-#define GET_PARAMETER_FROM_GRAPH_AND_CHECK(_arg) do {\
-    arg_info_t* argi = get_parameter_from_graph(ctx, _arg);\
+// _value: the equal sign of an inline value or NULL, _skip: label to jump to if the flag is rejected
+#define GET_PARAMETER_FROM_GRAPH_AND_CHECK(_arg, _arg_len, _text, _text_len, _offset, _allow_abbrev, _value, _skip) do {\
+    int __ambiguous;\
+    arg_info_t* argi = get_parameter_from_graph(ctx, _arg, _arg_len, _allow_abbrev, &__ambiguous);\
+    ctx->current_arg = argi;\
     if (!argi) {\
-        PARSEARG_REPORT_ERROR("unknown option --%s", _arg);\
+        PARSEARG_REPORT_ERROR(__ambiguous ? ARGPARSE_ERROR_AMBIGUOUS_OPTION : ARGPARSE_ERROR_UNKNOWN_OPTION, \
+                              i, NULL, _offset, _text, _text_len, 0);\
+        /* collecting errors, skip this flag */\
+        goto _skip;\
     } \
-    ctx->current_arg = argi;\
-    /* process if no need args */\
-    process_if_no_args(ctx);                         \
-    /* process directive, return directly */\
+    __current_arg_idx = __last_arg_idx;\
+    /* process directive, return directly, before flags without args (e.g., --help=pattern) */\
     /* for example,   git add [-A "xxxxxx"]  */\
-    if (ctx->current_arg && ctx->current_arg->directive_flag) { \
+    if (ctx->current_arg->directive_flag) { \
         LOG("  -- is a directive flag");                                             \
-        if (ctx->current_arg->process)               \
-            ctx->current_arg->process(ctx, argc - __last_arg_idx, argv + __last_arg_idx);\
+        invoke_process_(ctx, ctx->current_arg, argc - __last_arg_idx, argv + __last_arg_idx);\
         return OK;\
     }                                                     \
+    /* reject an inline value before the flag is processed, e.g., --verbose=3 */\
+    if ((_value) && argi->max_parameter_count == 0) {\
+        const char* __v = (_value) + 1;\
+        ctx->current_arg = NULL;\
+        PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_UNEXPECTED_VALUE, i, argi, (int)(__v - argv[i]), __v, \
+                              __views ? (int)VALUE_LEN(i, __v) : -1, 0);\
+        goto _skip;\
+    }\
+    /* process if no need args */\
+    if (process_if_no_args(ctx, __last_arg_idx) != OK) \
+        return FAIL;                                 \
 } while (0)
 
-int argparse_reset_env(args_context_t* ctx) {
+int argparse_add_constraint(args_context_t* ctx, argparse_constraint_type_t type, const int* options, int count) {
+    if (!ctx || !options || count <= 0) return FAIL;
+    if (type == ARGPARSE_CONSTRAINT_OCCURRENCE) {
+        LOGE("use argparse_set_occurrence_limit() for occurrence limits");
+        return FAIL;
+    }
+    if (type == ARGPARSE_CONSTRAINT_REQUIRES && count < 2) {
+        LOGE("requires constraint needs at least 2 parameters");
+        return FAIL;
+    }
+    for (int i=0; i<count; i++) {
+        if (options[i] < 0 || options[i] >= args_count_(ctx)) {
+            LOGE("invalid parameter id %d", options[i]);
+            return FAIL;
+        }
+    }
+    constraint_t* c = ARGPARSE_MALLOC(&ctx->allocator, sizeof(constraint_t) + count * sizeof(int));
+    if (!c) return FAIL;
+    c->type = type;
+    c->minc = 0;
+    c->maxc = 0;
+    c->count = count;
+    c->options = (int*)(c + 1);
+    memcpy(c->options, options, count * sizeof(int));
+    if (valarray_push_back(ctx->constraints, c) != OK) {
+        ARGPARSE_FREE(&ctx->allocator, c);
+        return FAIL;
+    }
+    ctx->constraints_dirty = 1;
+    return OK;
+}
+
+int argparse_set_occurrence_limit(args_context_t* ctx, int option, int minc, int maxc) {
     if (!ctx) return FAIL;
-    // reset env vars in ctx
-    ctx->current_arg = NULL;
-    // reset env vars in args
-    for (int i=0; i<ctx->args->size; i++) {
-        arg_info_t* _a = ctx->args->data[i];
-        assert(_a);
-        _a->_requirement_satisfied_sign = 0;
-        _a->_arg_name_sign = 0;
-        _a->result_item = NULL;
+    if (option < 0 || option >= args_count_(ctx) || minc < 0 || maxc < minc) {
+        LOGE("invalid occurrence limit for parameter id %d", option);
+        return FAIL;
     }
-    // free result if needed
-    if (ctx->last_result && !ctx->last_result->keep_this_obj) {
-        argparse_parse_result_deinit(ctx->last_result);
-        ctx->last_result = NULL;
+    constraint_t* c = ARGPARSE_MALLOC(&ctx->allocator, sizeof(constraint_t) + sizeof(int));
+    if (!c) return FAIL;
+    c->type = ARGPARSE_CONSTRAINT_OCCURRENCE;
+    c->minc = minc;
+    c->maxc = maxc;
+    c->count = 1;
+    c->options = (int*)(c + 1);
+    c->options[0] = option;
+    if (valarray_push_back(ctx->constraints, c) != OK) {
+        ARGPARSE_FREE(&ctx->allocator, c);
+        return FAIL;
     }
+    ctx->constraints_dirty = 1;
     return OK;
 }
 
-int parse_args(args_context_t* ctx, int argc, const char** argv) {
-    int __last_arg_idx = 0;
-    int __global_positonal_argc = 0;
-    argparse_reset_env(ctx);
+// build required mask and one mask per constraint, only when registration changed
+int constraints_compile_(args_context_t* ctx) {
+    if (!ctx->constraints_dirty)
+        return OK;
+    int count = args_count_(ctx);
+    int words = BITSET_WORDS(count);
+    if (words == 0) words = 1;
+    size_t nmasks = 1 + ctx->constraints->size;
+    uint64_t* masks = ARGPARSE_REALLOC(&ctx->allocator, ctx->masks, nmasks * words * sizeof(uint64_t));
+    if (!masks) return FAIL;
+    ctx->masks = masks;
+    uint64_t* seen = ARGPARSE_REALLOC(&ctx->allocator, ctx->seen, words * sizeof(uint64_t));
+    if (!seen) return FAIL;
+    ctx->seen = seen;
+    arg_info_t** by_id = ARGPARSE_REALLOC(&ctx->allocator, ctx->args_by_id, (count + 1) * sizeof(arg_info_t*));
+    if (!by_id) return FAIL;
+    ctx->args_by_id = by_id;
+    ctx->mask_words = words;
+    memset(masks, 0, nmasks * words * sizeof(uint64_t));
+    memset(by_id, 0, (count + 1) * sizeof(arg_info_t*)); // ids of removed parameters stay NULL
+    // inherited required parameters are required here as well
+    for (args_context_t* c = ctx; c; c = c->parent) {
+        for (size_t i=0; i<c->args->size; i++) {
+            arg_info_t* _a = c->args->data[i];
+            by_id[_a->id] = _a;
+            if (_a->required)
+                BITSET_SET(masks, _a->id);
+        }
+    }
+    for (size_t i=0; i<ctx->constraints->size; i++) {
+        constraint_t* c = ctx->constraints->data[i];
+        uint64_t* m = masks + (i + 1) * words;
+        // the first parameter of `requires` is the trigger, not part of the mask
+        for (int j = c->type == ARGPARSE_CONSTRAINT_REQUIRES ? 1 : 0; j < c->count; j++)
+            BITSET_SET(m, c->options[j]);
+    }
+    ctx->constraints_dirty = 0;
+    return OK;
+}
+
+// evaluate required args and all constraints against the seen set
+int constraints_check_(args_context_t* ctx) {
+    int words = ctx->mask_words;
+    uint64_t* seen = ctx->seen;
+    // required: required & ~seen
+    for (int k=0; k<words; k++) {
+        uint64_t w = ctx->masks[k] & ~seen[k];
+        while (w) {
+            int id = k * 64 + bitset_lowest_(w);
+            w &= w - 1;
+            PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_MISSING_REQUIRED, -1, ctx->args_by_id[id], 0, NULL, 0, 0);
+        }
+    }
+    for (size_t i=0; i<ctx->constraints->size; i++) {
+        constraint_t* c = ctx->constraints->data[i];
+        uint64_t* m = ctx->masks + (i + 1) * words;
+        if (c->type == ARGPARSE_CONSTRAINT_OCCURRENCE) {
+            arg_info_t* _a = ctx->args_by_id[c->options[0]];
+            int n = RESULT_ITEM(ctx, _a)->count;
+            if (n < c->minc || n > c->maxc)
+                PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_OCCURRENCE, -1, _a, 0, NULL, 0, n);
+            continue;
+        }
+        int first = -1, second = -1, missing = -1;
+        for (int k=0; k<words; k++) {
+            uint64_t hit = seen[k] & m[k];
+            uint64_t miss = m[k] & ~seen[k];
+            if (hit && first < 0) {
+                first = k * 64 + bitset_lowest_(hit);
+                hit &= hit - 1;
+            }
+            if (hit && second < 0)
+                second = k * 64 + bitset_lowest_(hit);
+            if (miss && missing < 0)
+                missing = k * 64 + bitset_lowest_(miss);
+        }
+        switch (c->type) {
+            case ARGPARSE_CONSTRAINT_MUTUALLY_EXCLUSIVE:
+                if (second >= 0)
+                    PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_MUTUALLY_EXCLUSIVE, -1, ctx->args_by_id[second], 0, NULL, 0, first);
+                break;
+            case ARGPARSE_CONSTRAINT_REQUIRES:
+                if (BITSET_TEST(seen, c->options[0]) && missing >= 0)
+                    PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_REQUIRES, -1, ctx->args_by_id[c->options[0]], 0, NULL, 0, missing);
+                break;
+            case ARGPARSE_CONSTRAINT_AT_LEAST_ONE:
+                if (first < 0)
+                    PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_AT_LEAST_ONE, -1, NULL, 0, NULL, 0, i);
+                break;
+            default:
+                break;
+        }
+    }
+    return OK;
+}
+
+// resolve value of a parameter with choices, returns FAIL if parsing should stop
+int check_choice_(args_context_t* ctx, arg_info_t* _a, const char* value, size_t len, int argv_index, int offset) {
+    if (!_a->choices) return OK;
+    int ambiguous;
+    ctx_node_t* node = ctx_graph_find_node(_a->choices, value, len, 1, &ambiguous);
+    if (!node) {
+        PARSEARG_REPORT_ERROR(ambiguous ? ARGPARSE_ERROR_AMBIGUOUS_CHOICE : ARGPARSE_ERROR_INVALID_CHOICE,
+                              argv_index, _a, offset, value, (int)len, 0);
+        return OK;
+    }
+    RESULT_ITEM(ctx, _a)->choice = node->index;
+    return OK;
+}
+
+// convert value into the bound field, returns FAIL if parsing should stop
+int bind_value_(args_context_t* ctx, arg_info_t* _a, const char* value, size_t len, int argv_index, int offset) {
+    // views are not NUL-terminated, converters may keep the value (e.g., strings), so they get a copy
+    if (ctx->parsing_views && value) {
+        if (!ctx->view_strings) {
+            ctx->view_strings = (string_pool_t*)ARGPARSE_MALLOC(&ctx->allocator, sizeof(string_pool_t));
+            if (!ctx->view_strings) return FAIL;
+            memset(ctx->view_strings, 0, sizeof(string_pool_t));
+        }
+        char* copy = (char*)string_pool_alloc_(ctx->view_strings, len + 1, 1, &ctx->allocator);
+        if (!copy) {
+            LOGE("allocate memory for value of view failed");
+            return FAIL;
+        }
+        memcpy(copy, value, len);
+        copy[len] = 0;
+        value = copy;
+    }
+    if (_a->bind_convert(_a->bind_dest, value, len) != OK)
+        PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_INVALID_VALUE, argv_index, _a, offset, value, (int)len, 0);
+    return OK;
+}
+
+int argparse_reset_env(args_context_t* ctx) {
+    if (!ctx) return FAIL;
+    // reset env vars in ctx
+    ctx->current_arg = NULL;
+    // free result if needed, never touch a result taken by the callee (it may be freed already)
+    if (ctx->last_result && !ctx->keep_last_result)
+        argparse_parse_result_deinit(ctx->last_result);
+    ctx->last_result = NULL;
+    ctx->keep_last_result = 0;
+    return OK;
+}
+
+// offset of the first '=' in s, or length of s if none
+size_t scan_equal_sign_(const char* s) {
+#ifdef ARGPARSE_SSE2
+    // aligned 16-byte loads never cross a page, so reading past the terminator is safe
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i equal = _mm_set1_epi8('=');
+    uintptr_t misalign = (uintptr_t)s & 15;
+    const char* p = s - misalign;
+    __m128i chunk = _mm_load_si128((const __m128i*)p);
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, zero), _mm_cmpeq_epi8(chunk, equal)));
+    mask &= ~0u << misalign;
+    while (!mask) {
+        p += 16;
+        chunk = _mm_load_si128((const __m128i*)p);
+        mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, zero), _mm_cmpeq_epi8(chunk, equal)));
+    }
+    return (size_t)(p - s) + bitset_lowest_(mask);
+#else
+    // bounded by the terminator
+    return strcspn(s, "=");
+#endif
+}
+
+// classify every argv token before parsing, so the parse loop branches on kinds only
+argv_token_t* classify_args_(args_context_t* ctx, int argc, const char** argv) {
+    if (argc + 1 > ctx->token_capacity) {
+        argv_token_t* _new = ARGPARSE_REALLOC(&ctx->allocator, ctx->tokens, (argc + 1) * sizeof(argv_token_t));
+        if (!_new) return NULL;
+        ctx->tokens = _new;
+        ctx->token_capacity = argc + 1;
+    }
+    argv_token_t* t = ctx->tokens;
+    for (int i=0; i<=argc; i++) {
+        const char* arg = argv[i];
+        t[i].eq = 0;
+        if (!arg)
+            t[i].kind = ARGV_TOKEN_NONE;
+        else if (arg[0] != '-')
+            t[i].kind = ARGV_TOKEN_POSITIONAL;
+        else if (arg[1] != '-')
+            t[i].kind = ARGV_TOKEN_SHORT;
+        else if (!arg[2])
+            t[i].kind = ARGV_TOKEN_SEPARATOR;
+        else {
+            t[i].eq = (uint32_t)scan_equal_sign_(arg + 2);
+            t[i].kind = arg[2 + t[i].eq] == '=' ? ARGV_TOKEN_LONG_VALUE : ARGV_TOKEN_LONG;
+        }
+    }
+    return t;
+}
+
+// classify views, and collect their pointers into a NULL-terminated array like argv
+argv_token_t* classify_views_(args_context_t* ctx, int argc, const argparse_view_t* views) {
+    if (argc + 1 > ctx->view_capacity) {
+        const char** _new = ARGPARSE_REALLOC(&ctx->allocator, ctx->view_ptrs, (argc + 1) * sizeof(const char*));
+        if (!_new) return NULL;
+        ctx->view_ptrs = _new;
+        ctx->view_capacity = argc + 1;
+    }
+    if (argc + 1 > ctx->token_capacity) {
+        argv_token_t* _new = ARGPARSE_REALLOC(&ctx->allocator, ctx->tokens, (argc + 1) * sizeof(argv_token_t));
+        if (!_new) return NULL;
+        ctx->tokens = _new;
+        ctx->token_capacity = argc + 1;
+    }
+    argv_token_t* t = ctx->tokens;
+    for (int i=0; i<argc; i++) {
+        const char* arg = views[i].ptr;
+        size_t len = views[i].len;
+        ctx->view_ptrs[i] = arg;
+        t[i].eq = 0;
+        if (!arg)
+            t[i].kind = ARGV_TOKEN_NONE;
+        else if (!len || arg[0] != '-')
+            t[i].kind = ARGV_TOKEN_POSITIONAL;
+        else if (len == 1 || arg[1] != '-')
+            t[i].kind = ARGV_TOKEN_SHORT;
+        else if (len == 2)
+            t[i].kind = ARGV_TOKEN_SEPARATOR;
+        else {
+            const char* eq = memchr(arg + 2, '=', len - 2);
+            t[i].eq = eq ? (uint32_t)(eq - (arg + 2)) : (uint32_t)(len - 2);
+            t[i].kind = eq ? ARGV_TOKEN_LONG_VALUE : ARGV_TOKEN_LONG;
+        }
+    }
+    ctx->view_ptrs[argc] = NULL;
+    t[argc].eq = 0;
+    t[argc].kind = ARGV_TOKEN_NONE;
+    return t;
+}
+
+// append to a list of a result, creating it on first use, growth is added to the bytes of the result
+int result_list_push_(parse_result_t* _r, valarray_t** list, void* value) {
+    if (!*list) {
+        if (valarray_init(list, &_r->allocator) != OK) {
+            *list = NULL;
+            return FAIL;
+        }
+        _r->bytes += VALARRAY_BYTES(*list);
+    }
+    size_t capacity = (*list)->capacity;
+    int ret = valarray_push_back(*list, value);
+    _r->bytes += ((*list)->capacity - capacity) * sizeof(val_array_element_t);
+    return ret;
+}
+
+// store a value, lengths are only recorded for views since argv strings are NUL-terminated
+void result_push_(parse_result_t* _r, valarray_t** values, valarray_t** lens, const char* value, size_t len) {
+    if (result_list_push_(_r, values, (void*)value) != OK || !_r->views) return;
+    result_list_push_(_r, lens, (void*)(uintptr_t)len);
+}
+
+// length of value v inside argv[i], views are not NUL-terminated
+#define VALUE_LEN(i, v)  (__views ? __views[i].len - (size_t)((v) - argv[i]) : strlen(v))
+#define ARG_LEN(i)       VALUE_LEN(i, argv[i])
+// if p is not the end of argument, end is NULL for NUL-terminated argv
+#define HAS_CHAR(p, end) ((end) ? (p) < (end) : *(p) != 0)
+
+// deliver the pending run of positional args in one call, argv is NULL for views (not batched)
+// the run is kept in the context so that it is also delivered when the parse returns early
+void flush_positional_run_(args_context_t* ctx, const char** argv) {
+    if (ctx->run_end > ctx->run_begin && ctx->process_positional_batch && argv)
+        ctx->process_positional_batch(ctx->run_first, ctx->run_end - ctx->run_begin, argv + ctx->run_begin);
+    ctx->run_begin = ctx->run_end = 0;
+}
+
+#define FLUSH_POSITIONAL_RUN() flush_positional_run_(ctx, __views ? NULL : argv)
+
+int parse_args_(args_context_t* ctx, int argc, const char** argv, const argparse_view_t* __views) {
+    int __last_arg_idx = 0;
+    int __current_arg_idx = 0;
+    int __global_positonal_argc = 0;
+    ctx->run_begin = ctx->run_end = 0;
+    ctx->error_count = 0;
+    ctx->action_count = 0;
+    if (constraints_compile_(ctx) != OK) {
+        LOGE("allocate memory for constraints failed");
+        return FAIL;
+    }
+    memset(ctx->seen, 0, ctx->mask_words * sizeof(uint64_t));
+    if (ctx->bind_presence)
+        memset(ctx->bind_presence, 0, BITSET_WORDS(args_count_(ctx)) * sizeof(uint64_t));
+    if (ctx->bind_counts)
+        memset(ctx->bind_counts, 0, args_count_(ctx) * sizeof(int));
+    // take back the last result if the callee does not keep it
+    parse_result_t* __reuse = NULL;
+    if (ctx->last_result && !ctx->keep_last_result) {
+        __reuse = ctx->last_result;
+        ctx->last_result = NULL;
+    }
+    argparse_reset_env(ctx);
     // initialize record of this time of parse
-    ctx->last_result = argparse_parse_result_init(ctx);
+    ctx->last_result = argparse_parse_result_recycle(ctx, __reuse);
     assert(ctx->last_result);
+    ctx->last_result->views = __views != NULL;
+    TRACE(ctx, ARGPARSE_TRACE_PARSE, -1, -1, argc);
 
     if (argc <= 1)
         goto final_check;
+    argv_token_t* __tokens = __views ? classify_views_(ctx, argc, __views) : classify_args_(ctx, argc, argv);
+    if (!__tokens) {
+        LOGE("allocate memory for argv tokens failed");
+        return FAIL;
+    }
+    if (__views)
+        argv = ctx->view_ptrs;
     for (int i = 1; i <= argc; i++) {
         const char* arg = argv[i];
         if (!arg) continue;
+        TRACE(ctx, ARGPARSE_TRACE_TOKEN, i, -1, __tokens[i].kind);
         LOG("--> %s", arg);
         // if is flag
-        if (arg[0] == '-') {
+        if (__tokens[i].kind >= ARGV_TOKEN_SHORT) {
             LOG("   * is a flag (- or --)");
+            FLUSH_POSITIONAL_RUN();
 
             // try process optional with no args
-            if (ctx->current_arg && ctx->current_arg->min_parameter_count == 0 && ctx->current_arg->max_parameter_count) {
+            if (OPTIONAL_WITHOUT_VALUES(ctx->current_arg)) {
                 LOG("do process for flag:  %s", arg_info_to_string(ctx->current_arg));
-                if (ctx->current_arg->process)
-                    ctx->current_arg->process(ctx, 0, NULL);
+                if (ctx->current_arg->bind_convert
+                    && bind_value_(ctx, ctx->current_arg, NULL, 0, __last_arg_idx, 0) != OK)
+                    return FAIL;
+                invoke_process_(ctx, ctx->current_arg, 0, NULL);
                 ctx->current_arg = NULL;
             }
 
@@ -782,11 +2869,11 @@ int parse_args(args_context_t* ctx, int argc, const char** argv) {
             __last_arg_idx = i;
 
             // if is --flag flag
-            if (arg[1] == '-') {
+            if (__tokens[i].kind != ARGV_TOKEN_SHORT) {
                 CHECK_ADDITIONAL_ARGS();
                 const char* long_term = arg + 2; // ignore --
                 // the flag is -- and enable remove_ambiguous
-                if (!*long_term && ctx->remove_ambiguous) {
+                if (__tokens[i].kind == ARGV_TOKEN_SEPARATOR && ctx->remove_ambiguous) {
                     ctx->current_arg = NULL;
 //                    // if last parameter requires args
 //                    if (ctx->current_arg && ctx->current_arg->min_parameter_count > 0) {
@@ -797,18 +2884,20 @@ int parse_args(args_context_t* ctx, int argc, const char** argv) {
                     continue;
                 }
                 LOG("process --%s", long_term);
-                GET_PARAMETER_FROM_GRAPH_AND_CHECK(long_term);
-                while (*(++arg)) {
-                    // if is --name=value
-                    if (*arg == '=') {
-                        goto process_inl_arg;
-                    }
+                GET_PARAMETER_FROM_GRAPH_AND_CHECK(long_term, __tokens[i].eq, long_term, __views ? (int)ARG_LEN(i) - 2 : -1, 2, 1,
+                                                   __tokens[i].kind == ARGV_TOKEN_LONG_VALUE ? long_term + __tokens[i].eq : NULL,
+                                                   next_token_);
+                // if is --name=value
+                if (__tokens[i].kind == ARGV_TOKEN_LONG_VALUE) {
+                    arg = long_term + __tokens[i].eq;
+                    goto process_inl_arg;
                 }
             }
             // if is -f flag
             else {
                 // process combined multiply parameters: -abcd
-                while (*(++arg)) {
+                const char* __end = __views ? arg + ARG_LEN(i) : NULL;
+                while (HAS_CHAR(++arg, __end)) {
                     // if is -n=value
                     if (*arg == '=') {
                         LOG("process inline equal sign");
@@ -820,13 +2909,19 @@ int parse_args(args_context_t* ctx, int argc, const char** argv) {
 
                     char __s[2] = {0, 0};  __s[0] = *arg;
                     LOG("process -%s", __s);
-                    GET_PARAMETER_FROM_GRAPH_AND_CHECK(__s);
+                    GET_PARAMETER_FROM_GRAPH_AND_CHECK(__s, 1, arg, 1, (int)(arg - argv[i]), 0,
+                                                       HAS_CHAR(arg + 1, __end) && arg[1] == '=' ? arg + 1 : NULL,
+                                                       next_short_flag_);
                     // check if is leading flag, e.g., -Dvariable=value
-                    LOG(" current flag: %d", ctx->current_arg->flag);
                     if (ctx->current_arg && _ACANE_HAS_FLAG(ctx->current_arg, FLAG_LEADING_PARAMETER)) {
-                        if (*(arg+1)) // if not an empty argg
+                        if (HAS_CHAR(arg + 1, __end)) // if not an empty argg
                             goto process_inl_arg;
                     }
+                    continue;
+next_short_flag_:
+                    // the inline value of a rejected flag is skipped with it, e.g., -x=1
+                    if (HAS_CHAR(arg + 1, __end) && arg[1] == '=')
+                        goto next_token_;
                 }
             }
 
@@ -837,15 +2932,27 @@ process_inl_arg:
                 // process inline positional arg xxx=value
                 LOG("inline positional arg for [%s]: %s", arg_info_to_string(ctx->current_arg), arg);
 
-                // Add this parameter (arg) to current_arg
-                valarray_push_back(ctx->current_arg->result_item->args, (void*)arg);
-                LOG("Added parameter to [%s] [arglist.size=%zu]: %s", arg_info_to_string(ctx->current_arg),
-                    ctx->current_arg->result_item->args->size, arg);
+                // Add this parameter (arg) to current_arg (none if no flag precedes the equal sign, e.g., -=value)
+                if (ctx->current_arg) {
+                    size_t __len = __views ? VALUE_LEN(i, arg) : 0; // argv values are NUL-terminated
+                    if (ctx->current_arg->choices
+                        && check_choice_(ctx, ctx->current_arg, arg, VALUE_LEN(i, arg), i, (int)(arg - argv[i])) != OK)
+                        return FAIL;
+                    parse_result_item_t* __ri = RESULT_ITEM(ctx, ctx->current_arg);
+                    if (!ctx->current_arg->bind_convert)
+                        result_push_(ctx->last_result, &__ri->args, &__ri->lens, arg, __len);
+                    else if (bind_value_(ctx, ctx->current_arg, arg, VALUE_LEN(i, arg), i, (int)(arg - argv[i])) != OK)
+                        return FAIL;
+                    TRACE(ctx, ARGPARSE_TRACE_VALUE, i, ctx->current_arg->id, __ri->args ? (int)__ri->args->size - 1 : 0);
+                    LOG("Added parameter to [%s] [arglist.size=%zu]: %s", arg_info_to_string(ctx->current_arg),
+                        RESULT_ITEM(ctx, ctx->current_arg)->args->size, arg);
+                }
 
                 // add this to ensure only one parameter will be obtained
                 ctx->current_arg = NULL;
             }
-
+next_token_:
+            ;
         }
         // if is parameters
         else {
@@ -855,16 +2962,28 @@ process_inl_arg:
             if (!ctx->current_arg) {
                 LOG("global positional arg: %s", arg);
                 if (ctx->positional_maxc < __global_positonal_argc + 1) {
-                    PARSEARG_REPORT_ERROR("unknown positional arg: %s", arg);
+                    PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_UNKNOWN_POSITIONAL, i, NULL, 0, arg, __views ? (int)ARG_LEN(i) : -1, 0);
+                    continue;
                 }
-                if (ctx->process_directive_positional) {
-                    // process as `git commit [-m "sadsadsa"]`
+                // positional args are contiguous in argv unless an error skipped some
+                if (ctx->run_end != i)
+                    FLUSH_POSITIONAL_RUN();
+                if (ctx->process_directive_positional && !__views) {
+                    // process as `git commit [-m "sadsadsa"]`, the pending run is delivered once the parse returns
                     if (ctx->process_directive_positional(__global_positonal_argc, argc - i, argv + i)) {
                         return OK;
                     }
                 }
-                if (ctx->process_positional)
+                if (ctx->process_positional && !__views)
                     ctx->process_positional(__global_positonal_argc, arg);
+                result_push_(ctx->last_result, &ctx->last_result->positionals, &ctx->last_result->positional_lens,
+                             arg, __views ? ARG_LEN(i) : 0);
+                TRACE(ctx, ARGPARSE_TRACE_VALUE, i, -1, __global_positonal_argc);
+                if (ctx->run_end == ctx->run_begin) {
+                    ctx->run_begin = i;
+                    ctx->run_first = __global_positonal_argc;
+                }
+                ctx->run_end = i + 1;
                 __global_positonal_argc++;
             }
             // if is args for certain parameters
@@ -872,40 +2991,1036 @@ process_inl_arg:
                 LOG("positional arg for [%s]: %s", arg_info_to_string(ctx->current_arg), arg);
 
                 // Add this parameter (argv[i]) to current_arg
-                valarray_push_back(ctx->current_arg->result_item->args, (void*)argv[i]);
+                size_t __len = __views ? ARG_LEN(i) : 0; // argv values are NUL-terminated
+                if (ctx->current_arg->choices && check_choice_(ctx, ctx->current_arg, arg, ARG_LEN(i), i, 0) != OK)
+                    return FAIL;
+                parse_result_item_t* __ri = RESULT_ITEM(ctx, ctx->current_arg);
+                if (!ctx->current_arg->bind_convert)
+                    result_push_(ctx->last_result, &__ri->args, &__ri->lens, arg, __len);
+                else if (bind_value_(ctx, ctx->current_arg, arg, ARG_LEN(i), i, 0) != OK)
+                    return FAIL;
+                TRACE(ctx, ARGPARSE_TRACE_VALUE, i, ctx->current_arg->id, __ri->args ? (int)__ri->args->size - 1 : 0);
                 LOG("Added parameter to [%s] [arglist.size=%zu]: %s", arg_info_to_string(ctx->current_arg),
-                    ctx->current_arg->result_item->args->size, argv[i]);
+                    RESULT_ITEM(ctx, ctx->current_arg)->args->size, argv[i]);
 
                 // If current parameter has args, and no args anymore, do process
-                if ((i + 1 < argc && argv[i+1][0] == '-'   // next arg is a flag
+                if ((i + 1 < argc && __tokens[i+1].kind >= ARGV_TOKEN_SHORT   // next arg is a flag
                     && ctx->current_arg && ctx->current_arg->max_parameter_count != 0)   // this parameter requires args
                     || (i + 1) >= argc      // no more args
                     || (ctx->current_arg && ctx->current_arg->max_parameter_count <= i - __last_arg_idx) // reach max count
                 ) {
                     LOG("do process for flag:  %s", arg_info_to_string(ctx->current_arg));
-                    if (ctx->current_arg->process)
-                        ctx->current_arg->process(ctx, i - __last_arg_idx, argv + __last_arg_idx + 1);
+                    invoke_process_(ctx, ctx->current_arg, i - __last_arg_idx, argv + __last_arg_idx + 1);
                     ctx->current_arg = NULL;
                 }
             }
         }
     }
 final_check:
+    FLUSH_POSITIONAL_RUN();
     if (ctx->current_arg && ctx->current_arg->min_parameter_count > 0) {
         CHECK_ADDITIONAL_ARGS();
     }
+    // the last parameter has optional values and got none
+    if (OPTIONAL_WITHOUT_VALUES(ctx->current_arg) && ctx->current_arg->bind_convert
+        && bind_value_(ctx, ctx->current_arg, NULL, 0, __last_arg_idx, 0) != OK)
+        return FAIL;
     // check required positional arguments
     if (ctx->positional_minc > __global_positonal_argc) {
-        PARSEARG_REPORT_ERROR("%d positional args provided, expected at least %d positional args",
-                              __global_positonal_argc, ctx->positional_minc);
+        PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_TOO_FEW_POSITIONAL, -1, NULL, 0, NULL, 0, __global_positonal_argc);
     }
-    // check required arguments
-    for (int i=0; i<ctx->args->size; i++) {
-        arg_info_t* __a = (arg_info_t*)ctx->args->data[i];
-        if (__a->required && __a->_requirement_satisfied_sign != ACANE_SIGN) {
-            PARSEARG_REPORT_ERROR("missing required arg: --%s", arg_info_to_string(__a));
+    // check required arguments and constraints
+    if (constraints_check_(ctx) != OK)
+        return FAIL;
+    // errors are only kept without stopping when collecting
+    return ctx->collect_errors && ctx->error_count ? FAIL : OK;
+}
+
+void spec_refresh_(args_context_t* ctx);
+
+int parse_args_common_(args_context_t* ctx, int argc, const char** argv, const argparse_view_t* views) {
+    if (!ctx) return FAIL;
+    if (ctx->spec && !ctx->version)
+        spec_refresh_(ctx);
+    ctx->parsing_views = views != NULL;
+    // copies of the last parse of views are released now, as documented
+    if (views)
+        string_pool_rewind_(ctx->view_strings, &ctx->allocator);
+    int ret = parse_args_(ctx, argc, argv, views);
+    ctx->parsing_views = 0;
+    // a run still pending when the parse stopped early, e.g., on an error
+    flush_positional_run_(ctx, views ? NULL : argv);
+    // results only grow during a parse, so the size they end with is the peak
+    ctx->peak_result_bytes = ctx->last_result && !ctx->keep_last_result ? ctx->last_result->bytes : 0;
+    if (ctx->deferred_actions) {
+        sort_actions_(ctx);
+        if (ret == OK)
+            run_actions_(ctx);
+    }
+    if (ret == OK && ctx->positional_task && !views)
+        ret = run_positional_tasks_(ctx);
+    return ret;
+}
+
+int parse_args(args_context_t* ctx, int argc, const char** argv) {
+    return parse_args_common_(ctx, argc, argv, NULL);
+}
+
+int parse_args_views(args_context_t* ctx, int argc, const argparse_view_t* argv) {
+    if (!argv) return FAIL;
+    return parse_args_common_(ctx, argc, NULL, argv);
+}
+
+// =================================================================================
+// hot-reloadable spec
+
+#ifndef ARGPARSE_NO_THREADS
+#define SPEC_LOCK(_spec)    pthread_mutex_lock(&(_spec)->lock)
+#define SPEC_UNLOCK(_spec)  pthread_mutex_unlock(&(_spec)->lock)
+#define SPEC_YIELD()        sched_yield()
+#else
+#define SPEC_LOCK(_spec)
+#define SPEC_UNLOCK(_spec)
+#define SPEC_YIELD()
+#endif
+
+// pin the published version, readers never wait for writers
+args_context_t* spec_pin_(argparse_spec_t* spec) {
+    int e;
+    for (;;) {
+        e = atomic_load(&spec->epoch);
+        atomic_fetch_add(&spec->readers[e], 1);
+        // entered the slot a writer drains after replacing `current`
+        if (atomic_load(&spec->epoch) == e)
+            break;
+        atomic_fetch_sub(&spec->readers[e], 1);
+    }
+    args_context_t* v = atomic_load(&spec->current);
+    atomic_fetch_add(&v->pins, 1);
+    atomic_fetch_sub(&spec->readers[e], 1);
+    return v;
+}
+
+// move a reader to the latest version, the previous one stays pinned until now (results refer to it)
+void spec_refresh_(args_context_t* ctx) {
+    args_context_t* v = spec_pin_(ctx->spec);
+    if (v == ctx->parent) {
+        atomic_fetch_sub(&v->pins, 1);
+        return;
+    }
+    if (ctx->parent)
+        atomic_fetch_sub(&ctx->parent->pins, 1);
+    ctx->parent = v;
+    ctx->id_base = args_count_(v);
+    ctx->constraints_dirty = 1;
+    help_index_free_(ctx); // the old version may be freed, and its address reused
+    order_views_free_(ctx);
+
+}
+
+// new version sharing the trie and parameters of `from`
+args_context_t* spec_version_init_(argparse_spec_t* spec, args_context_t* from) {
+    args_context_t* v = init_args_context_with_allocator(&spec->allocator);
+    if (!v) return NULL;
+    v->spec = spec;
+    v->version = 1;
+    v->ctx_graph->allocator = &spec->allocator;
+    ctx_graph_node_free(v->ctx_graph->head, &v->allocator);
+    v->ctx_graph->head = from ? from->ctx_graph->head : ctx_node_init(0, &spec->allocator);
+    if (!v->ctx_graph->head) {
+        deinit_args_context(v);
+        return NULL;
+    }
+    if (!from)
+        return v;
+    v->ctx_graph->head->refs++;
+    for (size_t i=0; i<from->args->size; i++) {
+        arg_info_t* _a = from->args->data[i];
+        if (valarray_push_back(v->args, _a) != OK) {
+            deinit_args_context(v);
+            return NULL;
+        }
+        _a->help->refs++;
+    }
+    v->id_holes = from->id_holes;
+    return v;
+}
+
+// free retired versions no reader pins anymore (writer only)
+void spec_reclaim_(argparse_spec_t* spec) {
+    for (size_t i=0; i<spec->retired->size; ) {
+        args_context_t* v = spec->retired->data[i];
+        if (atomic_load(&v->pins) == 0) {
+            deinit_args_context(v);
+            valarray_erase(spec->retired, i);
+        }
+        else i++;
+    }
+}
+
+argparse_spec_t* argparse_spec_init(const argparse_allocator_t* allocator) {
+    if (!allocator)
+        allocator = &argparse_default_allocator_;
+    if (!allocator->allocate || !allocator->reallocate || !allocator->deallocate) {
+        LOGE("allocator must provide allocate, reallocate and deallocate");
+        return NULL;
+    }
+    argparse_spec_t* spec = (argparse_spec_t*)ARGPARSE_MALLOC(allocator, sizeof(argparse_spec_t));
+    if (!spec) return NULL;
+    spec->allocator = *allocator;
+    atomic_init(&spec->epoch, 0);
+    atomic_init(&spec->readers[0], 0);
+    atomic_init(&spec->readers[1], 0);
+    spec->draft = NULL;
+    memset(&spec->params, 0, sizeof(arg_pool_t));
+    if (valarray_init(&spec->retired, &spec->allocator) != OK) {
+        ARGPARSE_FREE(allocator, spec);
+        return NULL;
+    }
+    args_context_t* v = spec_version_init_(spec, NULL);
+    if (!v) {
+        valarray_deinit(spec->retired);
+        ARGPARSE_FREE(allocator, spec);
+        return NULL;
+    }
+    atomic_store(&v->pins, 1);
+    atomic_init(&spec->current, v);
+#ifndef ARGPARSE_NO_THREADS
+    pthread_mutex_init(&spec->lock, NULL);
+#endif
+    return spec;
+}
+
+void argparse_spec_deinit(argparse_spec_t* spec) {
+    if (!spec) return;
+    if (spec->draft)
+        deinit_args_context(spec->draft);
+    args_context_t* v = atomic_load(&spec->current);
+    atomic_fetch_sub(&v->pins, 1);
+    valarray_push_back(spec->retired, v);
+    spec_reclaim_(spec);
+    // parameters of versions still pinned are leaked rather than freed under readers
+    if (spec->retired->size) {
+        LOGE("%zu versions are still pinned by readers, detach them first", spec->retired->size);
+    }
+    else
+        arg_pool_free_(&spec->params, &spec->allocator);
+    valarray_deinit(spec->retired);
+#ifndef ARGPARSE_NO_THREADS
+    pthread_mutex_destroy(&spec->lock);
+#endif
+    argparse_allocator_t allocator = spec->allocator;
+    ARGPARSE_FREE(&allocator, spec);
+}
+
+args_context_t* argparse_spec_edit(argparse_spec_t* spec) {
+    if (!spec) return NULL;
+    SPEC_LOCK(spec);
+    spec_reclaim_(spec);
+    spec->draft = spec_version_init_(spec, atomic_load(&spec->current));
+    if (!spec->draft)
+        SPEC_UNLOCK(spec);
+    return spec->draft;
+}
+
+int argparse_spec_publish(argparse_spec_t* spec) {
+    if (!spec || !spec->draft) return FAIL;
+    args_context_t* old = atomic_load(&spec->current);
+    args_context_t* v = spec->draft;
+    spec->draft = NULL;
+    atomic_store(&v->pins, 1);
+    atomic_store(&spec->current, v);
+    // readers that entered before the flip may still pin `old`, later ones see `v`
+    int e = atomic_load(&spec->epoch);
+    atomic_store(&spec->epoch, !e);
+    while (atomic_load(&spec->readers[e]))
+        SPEC_YIELD();
+    atomic_fetch_sub(&old->pins, 1);
+    valarray_push_back(spec->retired, old);
+    spec_reclaim_(spec);
+    SPEC_UNLOCK(spec);
+    return OK;
+}
+
+int argparse_spec_discard(argparse_spec_t* spec) {
+    if (!spec || !spec->draft) return FAIL;
+    deinit_args_context(spec->draft);
+    spec->draft = NULL;
+    SPEC_UNLOCK(spec);
+    return OK;
+}
+
+args_context_t* argparse_spec_attach(argparse_spec_t* spec) {
+    if (!spec) return NULL;
+    args_context_t* ctx = init_args_context_with_allocator(&spec->allocator);
+    if (!ctx) return NULL;
+    ctx->spec = spec;
+    spec_refresh_(ctx);
+    return ctx;
+}
+
+// =================================================================================
+// pull parser
+
+#define CURSOR_REPORT_ERROR(cur, ev, msg, ...) do { \
+    snprintf((cur)->error_buf, sizeof((cur)->error_buf), msg, ##__VA_ARGS__); \
+    (ev)->type = ARGPARSE_EVENT_ERROR; \
+    (ev)->message = (cur)->error_buf; \
+} while (0)
+
+int argparse_cursor_init(argparse_cursor_t* cur, args_context_t* ctx, int argc, const char** argv) {
+    if (!cur) return FAIL;
+    if (ctx && ctx->spec && !ctx->version)
+        spec_refresh_(ctx);
+    cur->ctx = ctx;
+    cur->argc = argc;
+    cur->argv = argv;
+    cur->index = 1; // skip program name
+    cur->cluster = NULL;
+    cur->positional_count = 0;
+    cur->inline_value = NULL;
+    cur->error_buf[0] = 0;
+    return ctx ? OK : FAIL;
+}
+
+// fill `ev` for an option, taking values from inline text or from following tokens
+int cursor_emit_option(argparse_cursor_t* cur, argparse_event_t* ev, arg_info_t* a, const char* inline_value) {
+    ev->type = ARGPARSE_EVENT_OPTION;
+    ev->long_term = a->long_term;
+    ev->short_term = a->short_term;
+    if (inline_value) {
+        cur->inline_value = inline_value;
+        ev->parac = 1;
+        ev->parav = &cur->inline_value;
+        return OK;
+    }
+    // directive takes all the rest, including itself (same as the process callback)
+    if (a->directive_flag) {
+        ev->parac = cur->argc - ev->index;
+        ev->parav = cur->argv + ev->index;
+        cur->index = cur->argc;
+        cur->cluster = NULL;
+        return OK;
+    }
+    // only the last flag of a combined -abc can take values
+    int n = 0;
+    if (!cur->cluster || !*cur->cluster) {
+        while (n < a->max_parameter_count && cur->index + n < cur->argc) {
+            const char* v = cur->argv[cur->index + n];
+            if (!v || v[0] == '-')
+                break;
+            n++;
+        }
+    }
+    ev->parac = n;
+    ev->parav = n ? cur->argv + cur->index : NULL;
+    cur->index += n;
+    if (n < a->min_parameter_count) {
+        if (a->help->err_msg)
+            CURSOR_REPORT_ERROR(cur, ev, "--%s: %s", arg_info_to_string(a), a->help->err_msg);
+        else
+            CURSOR_REPORT_ERROR(cur, ev, "at least %d additional arguments should provided for --%s",
+                                a->min_parameter_count, arg_info_to_string(a));
+    }
+    return OK;
+}
+
+int cursor_next_short(argparse_cursor_t* cur, argparse_event_t* ev) {
+    char __s[2] = {0, 0};  __s[0] = *cur->cluster++;
+    int ambiguous;
+    ctx_node_t* node = find_node_inherited_(cur->ctx, __s, 1, 0, 0, &ambiguous);
+    if (!node) {
+        CURSOR_REPORT_ERROR(cur, ev, "unknown option --%s", __s);
+        return OK;
+    }
+    arg_info_t* a = node->arg_info;
+    // -n=value, or leading flag such as -Dname=value
+    if (*cur->cluster == '=' || (*cur->cluster && _ACANE_HAS_FLAG(a, FLAG_LEADING_PARAMETER))) {
+        const char* value = cur->cluster + (*cur->cluster == '=');
+        cur->cluster = NULL;
+        return cursor_emit_option(cur, ev, a, value);
+    }
+    return cursor_emit_option(cur, ev, a, NULL);
+}
+
+int argparse_cursor_next(argparse_cursor_t* cur, argparse_event_t* ev) {
+    if (!cur || !ev) return FAIL;
+    ev->type = ARGPARSE_EVENT_END;
+    ev->index = cur->index;
+    ev->positional_index = -1;
+    ev->long_term = NULL;
+    ev->short_term = 0;
+    ev->parac = 0;
+    ev->parav = NULL;
+    ev->message = NULL;
+    if (!cur->ctx) return FAIL;
+    // continue combined flags: -abc
+    if (cur->cluster && *cur->cluster) {
+        ev->index = cur->index - 1;
+        return cursor_next_short(cur, ev);
+    }
+    cur->cluster = NULL;
+    for (; cur->index < cur->argc; cur->index++) {
+        const char* arg = cur->argv[cur->index];
+        // parse_args ignores these as well
+        if (!arg || (arg[0] == '-' && !arg[1]))
+            continue;
+        ev->index = cur->index++;
+        // positional arg
+        if (arg[0] != '-') {
+            ev->parac = 1;
+            ev->parav = cur->argv + ev->index;
+            if (cur->ctx->positional_maxc < cur->positional_count + 1) {
+                CURSOR_REPORT_ERROR(cur, ev, "unknown positional arg: %s", arg);
+                return OK;
+            }
+            ev->type = ARGPARSE_EVENT_POSITIONAL;
+            ev->positional_index = cur->positional_count++;
+            return OK;
+        }
+        // --flag
+        if (arg[1] == '-') {
+            const char* long_term = arg + 2;
+            if (!*long_term && cur->ctx->remove_ambiguous) {
+                ev->type = ARGPARSE_EVENT_SEPARATOR;
+                return OK;
+            }
+            int ambiguous;
+            ctx_node_t* node = find_node_inherited_(cur->ctx, long_term, strcspn(long_term, "="), 1, 0, &ambiguous);
+            if (!node) {
+                if (ambiguous)
+                    CURSOR_REPORT_ERROR(cur, ev, "--%s is ambiguous", long_term);
+                else
+                    CURSOR_REPORT_ERROR(cur, ev, "unknown option --%s", long_term);
+                return OK;
+            }
+            const char* eq = strchr(long_term, '=');
+            return cursor_emit_option(cur, ev, node->arg_info, eq ? eq + 1 : NULL);
         }
+        // -f flag
+        cur->cluster = arg + 1;
+        return cursor_next_short(cur, ev);
     }
+    return FAIL;
+}
+
+// =================================================================================
+// command interpreter
+
+#define IS_LINE_SPACE(ch) ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r')
+
+/// Split `line` in place with shell quoting rules ('...', "...", \x, # comment).
+/// Tokens are written back into `line`, every token pointer is passed to `push`.
+/// Returns count of tokens, or -1 for unterminated quote or failed push.
+int tokenize_line_(char* line, int (*push)(void* user, const char* token), void* user) {
+    char* r = line;  // read position
+    char* w = line;  // write position, never beyond r
+    int count = 0;
+    while (1) {
+        while (IS_LINE_SPACE(*r)) r++;
+        if (!*r || *r == '#')
+            break;
+        char* token = w;
+        while (*r && !IS_LINE_SPACE(*r)) {
+            if (*r == '\'') {
+                for (r++; *r != '\''; r++) {
+                    if (!*r) return -1;
+                    *w++ = *r;
+                }
+                r++;
+            }
+            else if (*r == '"') {
+                for (r++; *r != '"'; r++) {
+                    if (!*r) return -1;
+                    if (*r == '\\' && (r[1] == '"' || r[1] == '\\' || r[1] == '$' || r[1] == '`'))
+                        r++;
+                    else if (*r == '\\' && r[1] == '\n') {
+                        r++;
+                        continue;
+                    }
+                    *w++ = *r;
+                }
+                r++;
+            }
+            else if (*r == '\\') {
+                r++;
+                if (!*r) break;
+                if (*r != '\n')
+                    *w++ = *r;
+                r++;
+            }
+            else {
+                *w++ = *r++;
+            }
+        }
+        // r is at a separator or the end, which is already consumed
+        int at_end = !*r;
+        *w++ = 0;
+        if (!at_end) r++;
+        if (!push(user, token))
+            return -1;
+        count++;
+        if (at_end)
+            break;
+    }
+    return count;
+}
+
+typedef struct split_line_buf {
+    const char** argv;
+    int max_argc;
+    int argc;
+} split_line_buf_t;
+
+int split_line_push_(void* user, const char* token) {
+    split_line_buf_t* b = user;
+    if (b->argc >= b->max_argc)
+        return FAIL;
+    b->argv[b->argc++] = token;
+    return OK;
+}
+
+int argparse_split_line(char* line, const char** argv, int max_argc) {
+    if (!line || !argv) return -1;
+    split_line_buf_t b = { argv, max_argc, 0 };
+    return tokenize_line_(line, split_line_push_, &b);
+}
+
+struct argparse_interpreter {
+    argparse_allocator_t allocator;     // copied, the interpreter may outlive its context
+    args_context_t*      ctx;
+    const char*          program_name;
+    valarray_t*          argv;          // type: const char*, reused for every line
+};
+
+argparse_interpreter_t* argparse_interpreter_init(args_context_t* ctx, const char* program_name) {
+    if (!ctx) return NULL;
+    argparse_interpreter_t* it = (argparse_interpreter_t*)ARGPARSE_MALLOC(&ctx->allocator, sizeof(argparse_interpreter_t));
+    if (!it) return NULL;
+    it->allocator = ctx->allocator;
+    it->ctx = ctx;
+    it->program_name = program_name ? program_name : "";
+    if (valarray_init(&it->argv, &it->allocator) != OK) {
+        ARGPARSE_FREE(&ctx->allocator, it);
+        return NULL;
+    }
+    return it;
+}
+
+int interpreter_push_(void* user, const char* token) {
+    return valarray_push_back((valarray_t*)user, (void*)token);
+}
+
+int argparse_interpreter_exec(argparse_interpreter_t* it, char* line) {
+    if (!it || !line) return FAIL;
+    args_context_t* ctx = it->ctx;
+    it->argv->size = 0;
+    valarray_push_back(it->argv, (void*)it->program_name);
+    int count = tokenize_line_(line, interpreter_push_, it->argv);
+    if (count < 0) {
+        ctx->error_count = 0;
+        PARSEARG_REPORT_ERROR(ARGPARSE_ERROR_UNTERMINATED_QUOTE, -1, NULL, 0, NULL, 0, 0);
+        return FAIL;
+    }
+    // nothing to do for an empty line
+    if (count == 0)
+        return OK;
+    // parse_args reads argv[argc]
+    valarray_push_back(it->argv, NULL);
+    return parse_args(ctx, count + 1, (const char**)it->argv->data);
+}
+
+void argparse_interpreter_deinit(argparse_interpreter_t* it) {
+    if (!it) return;
+    valarray_deinit(it->argv);
+    ARGPARSE_FREE(&it->allocator, it);
+}
+
+// =================================================================================
+// multi-call binaries
+
+typedef struct applet {
+    const char*             name;   // NULL for a free slot
+    uint32_t                hash;
+    argparse_applet_setup_t setup;
+    void*                   user;
+    args_context_t*         ctx;    // built on first use
+    int                     failed; // setup failed, it is not retried
+} applet_t;
+
+struct argparse_multicall {
+    argparse_allocator_t allocator;
+    applet_t*            applets;   // open addressing, capacity is a power of 2
+    int                  capacity;
+    int                  count;
+};
+
+// slot holding `name`, or the free slot where it belongs
+applet_t* applet_slot_(applet_t* applets, int capacity, const char* name, size_t len, uint32_t hash) {
+    int mask = capacity - 1;
+    for (int i = hash & mask;; i = (i + 1) & mask) {
+        applet_t* a = &applets[i];
+        if (!a->name || (a->hash == hash && strncmp(a->name, name, len) == 0 && a->name[len] == 0))
+            return a;
+    }
+}
+
+int applet_grow_(argparse_multicall_t* mc) {
+    int capacity = mc->capacity ? mc->capacity * 2 : 16;
+    applet_t* applets = (applet_t*)ARGPARSE_MALLOC(&mc->allocator, capacity * sizeof(applet_t));
+    if (!applets) return FAIL;
+    memset(applets, 0, capacity * sizeof(applet_t));
+    for (int i=0; i<mc->capacity; i++) {
+        applet_t* a = &mc->applets[i];
+        if (a->name)
+            *applet_slot_(applets, capacity, a->name, strlen(a->name), a->hash) = *a;
+    }
+    if (mc->applets)
+        ARGPARSE_FREE(&mc->allocator, mc->applets);
+    mc->applets = applets;
+    mc->capacity = capacity;
+    return OK;
+}
+
+argparse_multicall_t* argparse_multicall_init(const argparse_allocator_t* allocator) {
+    if (!allocator)
+        allocator = &argparse_default_allocator_;
+    if (!allocator->allocate || !allocator->reallocate || !allocator->deallocate) {
+        LOGE("allocator must provide allocate, reallocate and deallocate");
+        return NULL;
+    }
+    argparse_multicall_t* mc = (argparse_multicall_t*)ARGPARSE_MALLOC(allocator, sizeof(argparse_multicall_t));
+    if (!mc) return NULL;
+    mc->allocator = *allocator;
+    mc->applets = NULL;
+    mc->capacity = 0;
+    mc->count = 0;
+    return mc;
+}
+
+void argparse_multicall_deinit(argparse_multicall_t* mc) {
+    if (!mc) return;
+    for (int i=0; i<mc->capacity; i++)
+        deinit_args_context(mc->applets[i].ctx);
+    if (mc->applets)
+        ARGPARSE_FREE(&mc->allocator, mc->applets);
+    ARGPARSE_FREE(&mc->allocator, mc);
+}
+
+int argparse_multicall_register(argparse_multicall_t* mc, const char* name, argparse_applet_setup_t setup, void* user) {
+    if (!mc || !name || !*name || !setup) return FAIL;
+    // keep the load under 3/4 so probes stay short
+    if ((mc->count + 1) * 4 > mc->capacity * 3 && applet_grow_(mc) != OK)
+        return FAIL;
+    size_t len = strlen(name);
+    uint32_t hash = string_hash_(name, len);
+    applet_t* a = applet_slot_(mc->applets, mc->capacity, name, len, hash);
+    if (a->name) {
+        LOGE("applet %s is already registered", name);
+        return FAIL;
+    }
+    a->name = name;
+    a->hash = hash;
+    a->setup = setup;
+    a->user = user;
+    a->ctx = NULL;
+    a->failed = 0;
+    mc->count++;
+    return OK;
+}
+
+// find an applet by the first `len` chars of `name`
+applet_t* multicall_find_(argparse_multicall_t* mc, const char* name, size_t len) {
+    if (!mc->count) return NULL;
+    applet_t* a = applet_slot_(mc->applets, mc->capacity, name, len, string_hash_(name, len));
+    return a->name ? a : NULL;
+}
+
+// context of an applet, built if not built yet, NULL if its setup failed (now or before)
+args_context_t* applet_context_(argparse_multicall_t* mc, applet_t* a) {
+    if (a->ctx || a->failed) return a->ctx;
+    args_context_t* ctx = init_args_context_with_allocator(&mc->allocator);
+    if (!ctx) return NULL;
+    if (a->setup(ctx, a->user) != OK) {
+        LOGE("setup of applet %s failed", a->name);
+        deinit_args_context(ctx);
+        a->failed = 1;
+        return NULL;
+    }
+    a->ctx = ctx;
+    return ctx;
+}
+
+args_context_t* argparse_multicall_get(argparse_multicall_t* mc, const char* name) {
+    if (!mc || !name) return NULL;
+    applet_t* a = multicall_find_(mc, name, strlen(name));
+    return a ? applet_context_(mc, a) : NULL;
+}
+
+int argparse_multicall_parse(argparse_multicall_t* mc, int argc, const char** argv, args_context_t** _out_ctx) {
+    if (_out_ctx) *_out_ctx = NULL;
+    if (!mc || argc < 1 || !argv || !argv[0]) return FAIL;
+    // dispatch on the name the binary is called by, then on the first argument (`box applet ...`)
+    const char* base = strrchr(argv[0], '/');
+    base = base ? base + 1 : argv[0];
+    applet_t* a = multicall_find_(mc, base, strlen(base));
+    if (!a && argc > 1 && argv[1][0] != '-') {
+        a = multicall_find_(mc, argv[1], strlen(argv[1]));
+        argc--;
+        argv++;
+    }
+    // an applet that failed to set up is still the selected one
+    args_context_t* ctx = a ? applet_context_(mc, a) : NULL;
+    if (!ctx) return FAIL;
+    if (_out_ctx) *_out_ctx = ctx;
+    return parse_args(ctx, argc, argv);
+}
+
+// =================================================================================
+// result snapshots
+
+#define SNAPSHOT_MAGIC 0x31535041 // "APS1"
+
+/* Snapshot of a parse result, relocatable: header, items, values, then NUL-terminated strings */
+typedef struct snapshot_header {
+    uint32_t magic;
+    uint32_t header_size;     // rejects snapshots of builds with another layout
+    uint64_t size;            // bytes of the whole snapshot
+    uint32_t item_count;
+    uint32_t value_count;     // values of items in order, then positionals
+    uint32_t positional_count;
+    uint32_t views;
+} snapshot_header_t;
+
+typedef struct snapshot_item {
+    uint32_t long_term;       // offset of name, 0 if none
+    int32_t  short_term;
+    int32_t  count;
+    int32_t  choice;
+    uint32_t first_value;
+    uint32_t value_count;
+} snapshot_item_t;
+
+typedef struct snapshot_value {
+    uint32_t offset;          // from the start of the snapshot
+    uint32_t len;             // without the NUL
+} snapshot_value_t;
+
+// lay out values of one array, strings are copied only if `buf` is given
+size_t snapshot_put_values_(parse_result_t* _r, valarray_t* values, valarray_t* lens, char* buf,
+                            snapshot_value_t* _out_v, size_t w) {
+    for (size_t i=0; values && i<values->size; i++) {
+        size_t len = value_len_(_r, values, lens, i);
+        if (buf) {
+            _out_v[i].offset = (uint32_t)w;
+            _out_v[i].len = (uint32_t)len;
+            memcpy(buf + w, values->data[i], len);
+            buf[w + len] = 0;
+        }
+        w += len + 1;
+    }
+    return w;
+}
+
+// write the snapshot into `buf` if given, returns its size
+size_t snapshot_build_(parse_result_t* _r, char* buf) {
+    snapshot_header_t* h = (snapshot_header_t*)buf;
+    size_t value_count = 0;
+    for (int i=0; i<_r->item_count; i++)
+        value_count += _r->items[i].args ? _r->items[i].args->size : 0;
+    snapshot_item_t* items = (snapshot_item_t*)(buf ? buf + sizeof(snapshot_header_t) : NULL);
+    snapshot_value_t* values = (snapshot_value_t*)(buf ? (char*)(items + _r->item_count) : NULL);
+    size_t w = sizeof(snapshot_header_t) + _r->item_count * sizeof(snapshot_item_t)
+               + (value_count + _r->positionals->size) * sizeof(snapshot_value_t);
+    uint32_t v = 0;
+    for (int i=0; i<_r->item_count; i++) {
+        parse_result_item_t* ri = &_r->items[i];
+        const char* name = ri->arginfo ? ri->arginfo->long_term : NULL;
+        if (buf) {
+            items[i].long_term = name ? (uint32_t)w : 0;
+            items[i].short_term = ri->arginfo ? ri->arginfo->short_term : 0;
+            items[i].count = ri->count;
+            items[i].choice = ri->choice;
+            items[i].first_value = v;
+            items[i].value_count = ri->args ? (uint32_t)ri->args->size : 0;
+        }
+        if (name) {
+            size_t len = strlen(name);
+            if (buf) memcpy(buf + w, name, len + 1);
+            w += len + 1;
+        }
+        w = snapshot_put_values_(_r, ri->args, ri->lens, buf, values ? values + v : NULL, w);
+        v += ri->args ? (uint32_t)ri->args->size : 0;
+    }
+    w = snapshot_put_values_(_r, _r->positionals, _r->positional_lens, buf, values ? values + v : NULL, w);
+    if (buf) {
+        h->magic = SNAPSHOT_MAGIC;
+        h->header_size = sizeof(snapshot_header_t);
+        h->size = w;
+        h->item_count = (uint32_t)_r->item_count;
+        h->value_count = (uint32_t)value_count;
+        h->positional_count = (uint32_t)_r->positionals->size;
+        h->views = (uint32_t)_r->views;
+    }
+    return w;
+}
+
+size_t argparse_snapshot_size(parse_result_t* _r) {
+    if (!_r) return 0;
+    size_t size = snapshot_build_(_r, NULL);
+    if (size > UINT32_MAX) {
+        LOGE("snapshot of %zu bytes exceeds offsets", size);
+        return 0;
+    }
+    return size;
+}
+
+size_t argparse_snapshot_write(parse_result_t* _r, void* buf, size_t size) {
+    size_t need = argparse_snapshot_size(_r);
+    if (!need || !buf || size < need) return 0;
+    return snapshot_build_(_r, (char*)buf);
+}
+
+// check a string of the snapshot lies inside it
+int snapshot_string_ok_(const char* base, size_t size, uint32_t offset, uint32_t len) {
+    return offset >= sizeof(snapshot_header_t) && (size_t)offset + len < size && base[offset + len] == 0;
+}
+
+// push values of a snapshot into arrays of the result, pointing into the snapshot
+int snapshot_get_values_(parse_result_t* _r, const char* base, size_t size, const snapshot_value_t* values,
+                         uint32_t count, valarray_t** _out_values, valarray_t** _out_lens) {
+    for (uint32_t i=0; i<count; i++) {
+        if (!snapshot_string_ok_(base, size, values[i].offset, values[i].len)) {
+            LOGE("snapshot value out of range");
+            return FAIL;
+        }
+        result_push_(_r, _out_values, _out_lens, base + values[i].offset, values[i].len);
+        if (!*_out_values || (_r->views && !*_out_lens))
+            return FAIL;
+    }
+    return OK;
+}
+
+parse_result_t* argparse_snapshot_attach(const void* buf, size_t size) {
+    const char* base = (const char*)buf;
+    const snapshot_header_t* h = (const snapshot_header_t*)buf;
+    if (!buf || size < sizeof(snapshot_header_t) || h->magic != SNAPSHOT_MAGIC
+        || h->header_size != sizeof(snapshot_header_t) || h->size > size) {
+        LOGE("not a parse result snapshot");
+        return NULL;
+    }
+    size = (size_t)h->size;
+    size_t index_bytes = sizeof(snapshot_header_t) + (size_t)h->item_count * sizeof(snapshot_item_t)
+                         + ((size_t)h->value_count + h->positional_count) * sizeof(snapshot_value_t);
+    if (index_bytes > size) {
+        LOGE("snapshot truncated");
+        return NULL;
+    }
+    const snapshot_item_t* items = (const snapshot_item_t*)(base + sizeof(snapshot_header_t));
+    const snapshot_value_t* values = (const snapshot_value_t*)(items + h->item_count);
+    const argparse_allocator_t* allocator = &argparse_default_allocator_;
+    parse_result_t* _r = (parse_result_t*)ARGPARSE_MALLOC(allocator, sizeof(parse_result_t));
+    if (!_r) return NULL;
+    memset(_r, 0, sizeof(parse_result_t));
+    _r->allocator = *allocator;
+    _r->views = h->views != 0;
+    _r->item_count = (int)h->item_count;
+    _r->items = (parse_result_item_t*)ARGPARSE_MALLOC(allocator, (h->item_count ? h->item_count : 1)
+                                                                 * sizeof(parse_result_item_t));
+    _r->snapshot_args = (arg_info_t*)ARGPARSE_MALLOC(allocator, (h->item_count ? h->item_count : 1) * sizeof(arg_info_t));
+    if (!_r->items || !_r->snapshot_args || valarray_init(&_r->positionals, &_r->allocator) != OK) {
+        _r->item_count = 0;
+        goto fail;
+    }
+    for (uint32_t i=0; i<h->item_count; i++)
+        argparse_parse_result_item_init(&_r->items[i], NULL);
+    // only names are kept, they are all the result API needs of parameters
+    for (uint32_t i=0; i<h->item_count; i++) {
+        const snapshot_item_t* si = &items[i];
+        parse_result_item_t* ri = &_r->items[i];
+        if ((size_t)si->first_value + si->value_count > h->value_count) {
+            LOGE("snapshot item out of range");
+            goto fail;
+        }
+        if (si->long_term || si->short_term) {
+            arg_info_t* _a = &_r->snapshot_args[i];
+            memset(_a, 0, sizeof(arg_info_t));
+            if (si->long_term && (si->long_term >= size || !memchr(base + si->long_term, 0, size - si->long_term))) {
+                LOGE("snapshot name out of range");
+                goto fail;
+            }
+            _a->long_term = si->long_term ? base + si->long_term : NULL;
+            _a->short_term = (char)si->short_term;
+            _a->id = (int)i;
+            ri->arginfo = _a;
+        }
+        ri->count = si->count;
+        ri->choice = si->choice;
+        if (snapshot_get_values_(_r, base, size, values + si->first_value, si->value_count, &ri->args, &ri->lens) != OK)
+            goto fail;
+    }
+    if (snapshot_get_values_(_r, base, size, values + h->value_count, h->positional_count,
+                             &_r->positionals, &_r->positional_lens) != OK)
+        goto fail;
+    return _r;
+
+fail:
+    argparse_parse_result_deinit(_r);
+    return NULL;
+}
+
+int argparse_snapshot_write_fd(parse_result_t* _r, int fd) {
+#ifndef ARGPARSE_NO_MMAP
+    size_t size = argparse_snapshot_size(_r);
+    if (!size) return FAIL;
+    char* buf = (char*)ARGPARSE_MALLOC(&_r->allocator, size);
+    if (!buf) return FAIL;
+    snapshot_build_(_r, buf);
+    size_t w = 0;
+    while (w < size) {
+        ssize_t n = write(fd, buf + w, size - w);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        w += (size_t)n;
+    }
+    ARGPARSE_FREE(&_r->allocator, buf);
+    if (w < size) {
+        LOGE("write snapshot failed: %s", strerror(errno));
+        return FAIL;
+    }
+    return OK;
+#else
+    LOGE("snapshots on file descriptors are not supported (built with ARGPARSE_NO_MMAP)");
+    return FAIL;
+#endif
+}
+
+parse_result_t* argparse_snapshot_attach_fd(int fd) {
+#ifndef ARGPARSE_NO_MMAP
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(snapshot_header_t)) {
+        LOGE("not a parse result snapshot");
+        return NULL;
+    }
+    void* mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        LOGE("map snapshot failed: %s", strerror(errno));
+        return NULL;
+    }
+    parse_result_t* _r = argparse_snapshot_attach(mapping, (size_t)st.st_size);
+    if (!_r) {
+        munmap(mapping, (size_t)st.st_size);
+        return NULL;
+    }
+    _r->mapping = mapping;
+    _r->mapping_size = (size_t)st.st_size;
+    return _r;
+#else
+    LOGE("snapshots on file descriptors are not supported (built with ARGPARSE_NO_MMAP)");
+    return NULL;
+#endif
+}
+
+// =================================================================================
+// memory accounting
+
+void trie_memory_stats_(ctx_node_t* __n, argparse_memory_stats_t* _s) {
+    if (!__n) return;
+    _s->trie_node_count++;
+    _s->trie_node_bytes += sizeof(ctx_node_t) + VALARRAY_BYTES(__n->children);
+    _s->allocation_count += 1 + VALARRAY_ALLOCATIONS(__n->children);
+    for (size_t i=0; i<__n->children->size; i++)
+        trie_memory_stats_(__n->children->data[i], _s);
+}
+
+void result_memory_stats_(parse_result_t* _r, argparse_memory_stats_t* _s) {
+    memset(_s, 0, sizeof(argparse_memory_stats_t));
+    _s->result_item_count = _r->item_count;
+    _s->result_item_bytes = sizeof(parse_result_t) + (_r->item_count ? _r->item_count : 1) * sizeof(parse_result_item_t);
+    _s->result_item_bytes += VALARRAY_BYTES(_r->positionals);
+    _s->allocation_count = 2 + VALARRAY_ALLOCATIONS(_r->positionals);
+    if (_r->positional_lens) {
+        _s->result_item_bytes += VALARRAY_BYTES(_r->positional_lens);
+        _s->allocation_count += VALARRAY_ALLOCATIONS(_r->positional_lens);
+    }
+    for (int i=0; i<_r->item_count; i++) {
+        parse_result_item_t* ri = &_r->items[i];
+        if (ri->args) {
+            _s->result_item_bytes += VALARRAY_BYTES(ri->args);
+            _s->allocation_count += VALARRAY_ALLOCATIONS(ri->args);
+        }
+        if (ri->lens) {
+            _s->result_item_bytes += VALARRAY_BYTES(ri->lens);
+            _s->allocation_count += VALARRAY_ALLOCATIONS(ri->lens);
+        }
+    }
+    _s->total_bytes = _s->result_item_bytes;
+    _s->peak_parse_bytes = _s->total_bytes;
+}
+
+int argparse_get_memory_stats(args_context_t* ctx, argparse_memory_stats_t* _out_s) {
+    if (!ctx || !_out_s) return FAIL;
+    memset(_out_s, 0, sizeof(argparse_memory_stats_t));
+    // context itself and graph holder
+    _out_s->context_bytes = sizeof(args_context_t) + sizeof(ctx_graph_t);
+    _out_s->allocation_count = 2;
+    trie_memory_stats_(ctx->ctx_graph->head, _out_s);
+    // arg infos, their pool and their list
+    arg_pool_t* pool = params_(ctx);
+    _out_s->arg_info_count = ctx->args->size;
+    _out_s->arg_info_bytes = VALARRAY_BYTES(ctx->args);
+    _out_s->allocation_count += VALARRAY_ALLOCATIONS(ctx->args);
+    for (int c=0; c<ARG_POOL_CHUNKS; c++) {
+        if (!pool->chunks[c]) continue;
+        _out_s->arg_info_bytes += ARG_POOL_CHUNK_BYTES(c);
+        _out_s->allocation_count++;
+    }
+    for (size_t i=0; i<ctx->args->size; i++) {
+        arg_info_t* _a = ctx->args->data[i];
+        if (_a->choices) {
+            _out_s->trie_node_bytes += sizeof(ctx_graph_t);
+            _out_s->allocation_count++;
+            trie_memory_stats_(_a->choices->head, _out_s);
+        }
+    }
+    // positional names and descriptions
+    _out_s->positional_bytes = VALARRAY_BYTES(ctx->positional_args) + VALARRAY_BYTES(ctx->positional_args_description);
+    _out_s->allocation_count += VALARRAY_ALLOCATIONS(ctx->positional_args) + VALARRAY_ALLOCATIONS(ctx->positional_args_description);
+    // string pool
+    if (ctx->strings) {
+        _out_s->string_bytes = sizeof(string_pool_t) + ctx->strings->capacity * sizeof(interned_t);
+        _out_s->allocation_count += 1 + (ctx->strings->table != NULL);
+        for (string_chunk_t* c = ctx->strings->chunks; c; c = c->next) {
+            _out_s->string_bytes += sizeof(string_chunk_t) + c->size;
+            _out_s->allocation_count++;
+        }
+    }
+    if (ctx->view_strings) {
+        _out_s->string_bytes += sizeof(string_pool_t);
+        _out_s->allocation_count++;
+        for (string_chunk_t* c = ctx->view_strings->chunks; c; c = c->next) {
+            _out_s->string_bytes += sizeof(string_chunk_t) + c->size;
+            _out_s->allocation_count++;
+        }
+    }
+    _out_s->total_bytes = _out_s->context_bytes + _out_s->trie_node_bytes + _out_s->arg_info_bytes
+                          + _out_s->positional_bytes + _out_s->string_bytes;
+    // result still owned by the context
+    if (ctx->last_result && !ctx->keep_last_result) {
+        argparse_memory_stats_t __r;
+        result_memory_stats_(ctx->last_result, &__r);
+        _out_s->result_item_count = __r.result_item_count;
+        _out_s->result_item_bytes = __r.result_item_bytes;
+        _out_s->allocation_count += __r.allocation_count;
+        _out_s->total_bytes += __r.total_bytes;
+    }
+    _out_s->peak_parse_bytes = _out_s->total_bytes - _out_s->result_item_bytes + ctx->peak_result_bytes;
+    return OK;
+}
+
+int argparse_get_result_memory_stats(parse_result_t* _r, argparse_memory_stats_t* _out_s) {
+    if (!_r || !_out_s) return FAIL;
+    result_memory_stats_(_r, _out_s);
     return OK;
 }
 
@@ -914,6 +4029,45 @@ int argparse_set_positional_arg_process(args_context_t* ctx, void (*process)(int
     return OK;
 }
 
+int argparse_set_positional_batch_process(args_context_t* ctx, void (*process)(int first_index, int count, const char** args)) {
+    ctx->process_positional_batch = process;
+    return OK;
+}
+
+int argparse_set_thread_pool(args_context_t* ctx, int threads) {
+    if (!ctx || threads < 0) return FAIL;
+#ifndef ARGPARSE_NO_THREADS
+    pool_free_(ctx->pool);
+    ctx->pool = NULL;
+    if (!threads) return OK;
+    ctx->pool = pool_init_(&ctx->allocator, threads);
+    if (!ctx->pool) {
+        LOGE("create thread pool failed");
+        return FAIL;
+    }
+    return OK;
+#else
+    if (!threads) return OK;
+    LOGE("thread pool is not supported (built with ARGPARSE_NO_THREADS)");
+    return FAIL;
+#endif
+}
+
+int argparse_set_positional_task(args_context_t* ctx, int (*task)(int index, const char* arg, void* user),
+                                 int (*lane)(int index, const char* arg, void* user), void* user) {
+    if (!ctx) return FAIL;
+    ctx->positional_task = task;
+    ctx->positional_lane = lane;
+    ctx->positional_task_user = user;
+    return OK;
+}
+
+int argparse_set_parallel_actions(args_context_t* ctx, int enable) {
+    if (!ctx) return FAIL;
+    ctx->parallel_actions = enable;
+    return OK;
+}
+
 int argparse_set_directive_positional_arg_process(args_context_t* ctx, int (*process)(int index, int argc, const char** argv)) {
     ctx->process_directive_positional = process;
     return OK;
@@ -953,7 +4107,7 @@ void print_line_wrap(args_context_t* ctx, const char* str, int leading_spaces) {
     int lwc=0; // line word count
     int lcc=0; // line character count
     int lccmax = ctx->help_line_width;
-    char* buf = malloc(strlen(str) + 1);
+    char* buf = ARGPARSE_MALLOC(&ctx->allocator, strlen(str) + 1);
     char* pbuf = buf;
     strcpy(buf, str);
     int flag = 1;
@@ -977,6 +4131,7 @@ void print_line_wrap(args_context_t* ctx, const char* str, int leading_spaces) {
         pbuf += len + 1;  str += len + 1;
         flag = *(str-1);
     }
+    ARGPARSE_FREE(&ctx->allocator, buf);
 }
 
 int help_print_addi_parameters_name_to_str(arg_info_t* __a, const char* str, char* buf) {
@@ -1009,7 +4164,7 @@ int print_help_paramater_info(args_context_t* ctx, arg_info_t* arginfo, char** _
     if (arginfo->short_term) {
         _width += sprintf(buf + _width, "-%c", arginfo->short_term);
         if (!arginfo->long_term && arginfo->min_parameter_count > 0) {
-            PRINT_HELP_PARAMETER_(arginfo->arg_name);
+            PRINT_HELP_PARAMETER_(arginfo->help->arg_name);
         }
     }
     if (arginfo->long_term) {
@@ -1021,38 +4176,394 @@ int print_help_paramater_info(args_context_t* ctx, arg_info_t* arginfo, char** _
         }
         _width += sprintf(buf + _width, "--%s", arginfo->long_term);
         if (arginfo->max_parameter_count > 0) {
-            PRINT_HELP_PARAMETER_(arginfo->arg_name);
+            PRINT_HELP_PARAMETER_(arginfo->help->arg_name);
         }
     }
     *_out_buf = buf;
     return _width;
 }
 
+// one parameter in help, the name column is padded to help_leading_spaces and the description wrapped
+void print_help_entry_(args_context_t* ctx, arg_info_t* __a) {
+    char* buf = NULL;
+    int width = print_help_paramater_info(ctx, __a, &buf);
+    fprintf(ctx->output_file, "%s", buf);
+    if (ctx->help_leading_spaces <= width) {
+        fprintf(ctx->output_file, "\n");
+        width = 0;
+    }
+    int remain = ctx->help_leading_spaces - width;
+    for (int i=0; i<remain; i++)
+        fprintf(ctx->output_file, " ");
+    if (__a->help->description) {
+        print_line_wrap(ctx, __a->help->description, ctx->help_leading_spaces);
+    }
+    fprintf(ctx->output_file, "\n");
+}
+
+// =================================================================================
+// parameter orders
+
+#define ORDER_COUNT (ARGPARSE_ORDER_SECTION + 1)
+
+/* Parameters (inherited ones too) in each order, index views over the parameter lists */
+typedef struct order_views {
+    arg_info_t** args[ORDER_COUNT];   // NULL until used
+    int count;
+    // parameters the views were built for
+    args_context_t* parent;
+    int args_count;
+    int id_holes;
+} order_views_t;
+
+void order_views_free_(args_context_t* ctx) {
+    if (!ctx->views) return;
+    for (int o=0; o<ORDER_COUNT; o++)
+        if (ctx->views->args[o])
+            ARGPARSE_FREE(&ctx->allocator, ctx->views->args[o]);
+    ARGPARSE_FREE(&ctx->allocator, ctx->views);
+    ctx->views = NULL;
+}
+
+// by long term (short term if none), then by id
+int arg_name_compare_(const arg_info_t* a, const arg_info_t* b) {
+    char sa[2] = { a->short_term, 0 };
+    char sb[2] = { b->short_term, 0 };
+    int d = strcmp(a->long_term ? a->long_term : sa, b->long_term ? b->long_term : sb);
+    return d ? d : a->id - b->id;
+}
+
+// bottom-up merge sort by name, no recursion and O(n log n) on any input
+void sort_args_by_name_(arg_info_t** args, arg_info_t** tmp, int n) {
+    arg_info_t** src = args;
+    arg_info_t** dst = tmp;
+    for (int width=1; width<n; width*=2) {
+        for (int lo=0; lo<n; lo+=2*width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+            int a = lo, b = mid, k = lo;
+            while (a < mid && b < hi)
+                dst[k++] = arg_name_compare_(src[b], src[a]) < 0 ? src[b++] : src[a++];
+            while (a < mid) dst[k++] = src[a++];
+            while (b < hi)  dst[k++] = src[b++];
+        }
+        arg_info_t** t = src; src = dst; dst = t;
+    }
+    if (src != args)
+        memcpy(args, src, n * sizeof(arg_info_t*));
+}
+
+// by section, then by position in args, interned sections compare by pointer
+int section_compare_(arg_info_t* const* args, int a, int b) {
+    const char* sa = args[a]->help->section;
+    const char* sb = args[b]->help->section;
+    int d = sa == sb ? 0 : strcmp(sa, sb);
+    return d ? d : a - b;
+}
+
+// bottom-up merge sort of positions in args (all with a section) by section_compare_()
+void sort_items_by_section_(int* items, int* tmp, arg_info_t* const* args, int n) {
+    int* src = items;
+    int* dst = tmp;
+    for (int width=1; width<n; width*=2) {
+        for (int lo=0; lo<n; lo+=2*width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+            int a = lo, b = mid, k = lo;
+            while (a < mid && b < hi)
+                dst[k++] = section_compare_(args, src[b], src[a]) < 0 ? src[b++] : src[a++];
+            while (a < mid) dst[k++] = src[a++];
+            while (b < hi)  dst[k++] = src[b++];
+        }
+        int* t = src; src = dst; dst = t;
+    }
+    if (src != items)
+        memcpy(items, src, n * sizeof(int));
+}
+
+// order by keys, stable so registration order is kept within a key
+void sort_args_by_key_(arg_info_t** args, arg_info_t** tmp, int* keys, int* items, int* scratch, int n) {
+    for (int i=0; i<n; i++)
+        items[i] = i;
+    sort_items_by_key_(items, scratch, keys, n);
+    for (int i=0; i<n; i++)
+        tmp[i] = args[items[i]];
+    memcpy(args, tmp, n * sizeof(arg_info_t*));
+}
+
+// parameters in `order`, own ones first in registration order
+arg_info_t** order_view_(args_context_t* ctx, int order, int* _out_count) {
+    if (order < 0 || order >= ORDER_COUNT) return NULL;
+    order_views_t* views = ctx->views;
+    if (!views || views->parent != ctx->parent || views->args_count != args_count_(ctx) || views->id_holes != ctx->id_holes) {
+        order_views_free_(ctx);
+        views = (order_views_t*)ARGPARSE_MALLOC(&ctx->allocator, sizeof(order_views_t));
+        if (!views) return NULL;
+        memset(views, 0, sizeof(order_views_t));
+        for (args_context_t* c = ctx; c; c = c->parent)
+            views->count += c->args->size;
+        views->parent = ctx->parent;
+        views->args_count = args_count_(ctx);
+        views->id_holes = ctx->id_holes;
+        ctx->views = views;
+    }
+    int n = views->count;
+    *_out_count = n;
+    if (views->args[order])
+        return views->args[order];
+    arg_info_t** args = (arg_info_t**)ARGPARSE_MALLOC(&ctx->allocator, (n ? n : 1) * sizeof(arg_info_t*));
+    if (!args) return NULL;
+    int k = 0;
+    for (args_context_t* c = ctx; c; c = c->parent)
+        for (size_t i=0; i<c->args->size; i++)
+            args[k++] = c->args->data[i];
+    if (order != ARGPARSE_ORDER_REGISTRATION && n > 1) {
+        // n pointers, then keys, items and merge scratch
+        arg_info_t** tmp = (arg_info_t**)ARGPARSE_MALLOC(&ctx->allocator, n * (sizeof(arg_info_t*) + 3 * sizeof(int)));
+        if (!tmp) {
+            ARGPARSE_FREE(&ctx->allocator, args);
+            return NULL;
+        }
+        int* keys = (int*)(tmp + n);
+        int* items = keys + n;
+        int* scratch = items + n;
+        if (order == ARGPARSE_ORDER_ALPHABETICAL)
+            sort_args_by_name_(args, tmp, n);
+        else if (order == ARGPARSE_ORDER_REQUIRED_FIRST) {
+            for (int i=0; i<n; i++)
+                keys[i] = !args[i]->required;
+            sort_args_by_key_(args, tmp, keys, items, scratch, n);
+        }
+        else {
+            // a section sorts at its first parameter, parameters without one come first:
+            // sorted by (section, position), the first parameter of each run of a section gives the key
+            int m = 0;
+            for (int i=0; i<n; i++) {
+                keys[i] = 0;
+                if (args[i]->help->section)
+                    items[m++] = i;
+            }
+            sort_items_by_section_(items, scratch, args, m);
+            for (int j=0; j<m; j++) {
+                const char* section = args[items[j]]->help->section;
+                const char* prev = j ? args[items[j-1]]->help->section : NULL;
+                keys[items[j]] = prev && (prev == section || strcmp(prev, section) == 0) ? keys[items[j-1]] : items[j] + 1;
+            }
+            sort_args_by_key_(args, tmp, keys, items, scratch, n);
+        }
+        ARGPARSE_FREE(&ctx->allocator, tmp);
+    }
+    views->args[order] = args;
+    return args;
+}
+
+int argparse_get_parameter_order(args_context_t* ctx, argparse_order_t order, int* _out_ids, int max_count) {
+    if (!ctx) return -1;
+    int count;
+    arg_info_t** args = order_view_(ctx, order, &count);
+    if (!args) return -1;
+    for (int i=0; _out_ids && i<count && i<max_count; i++)
+        _out_ids[i] = args[i]->id;
+    return count;
+}
+
+int argparse_set_help_order(args_context_t* ctx, argparse_order_t order) {
+    if (!ctx || order < 0 || order >= ORDER_COUNT) return FAIL;
+    ctx->help_order = order;
+    return OK;
+}
+
+int argparse_set_usage_order(args_context_t* ctx, argparse_order_t order) {
+    if (!ctx || order < 0 || order >= ORDER_COUNT) return FAIL;
+    ctx->usage_order = order;
+    return OK;
+}
+
+// count of entries printed, inherited ones included, -1 if failed
+int print_help_(args_context_t* ctx) {
+    assert(ctx->args);
+    int count;
+    arg_info_t** args = order_view_(ctx, ctx->help_order, &count);
+    if (!args) return -1;
+    const char* section = NULL;
+    for (int i=0; i<count; i++) {
+        // sections get a title when grouped
+        const char* s = args[i]->help->section;
+        if (ctx->help_order == ARGPARSE_ORDER_SECTION && s && (!section || strcmp(s, section) != 0)) {
+            fprintf(ctx->output_file, "\n%s:\n", s);
+            section = s;
+        }
+        print_help_entry_(ctx, args[i]);
+    }
+    return count;
+}
+
 int argparse_print_help(args_context_t* ctx) {
     if (!ctx) return FAIL;
-    assert(ctx->args);
-    for (int i=0; i<ctx->args->size; i++) {
-        arg_info_t* __a = (arg_info_t *) ctx->args->data[i];
-        char* buf = NULL;
-        int width = print_help_paramater_info(ctx, __a, &buf);
-        fprintf(ctx->output_file, "%s", buf);
-        //LOG("  short: %c   long: %s,  minc: %d, maxc: %d\n", __a->short_term, __a->long_term, __a->min_parameter_count, __a->max_parameter_count);
-        //LOG("    print count=%d", width);
-        if (ctx->help_leading_spaces <= width) {
-            fprintf(ctx->output_file, "\n");
-            width = 0;
+    return print_help_(ctx) < 0 ? FAIL : OK;
+}
+
+// =================================================================================
+// help search
+
+/* Word of a description or a segment of a long name */
+typedef struct help_word {
+    const char* word;   // borrowed from the description or name
+    int len;
+    arg_info_t* arginfo;
+} help_word_t;
+
+/* Index of words of all parameters (inherited ones too), sorted case-insensitively */
+typedef struct help_index {
+    help_word_t* words;
+    int count;
+    int capacity;
+    // parameters the index was built for
+    args_context_t* parent;
+    int args_count;
+    int id_holes;
+} help_index_t;
+
+void help_index_free_(args_context_t* ctx) {
+    if (!ctx->help_index) return;
+    if (ctx->help_index->words)
+        ARGPARSE_FREE(&ctx->allocator, ctx->help_index->words);
+    ARGPARSE_FREE(&ctx->allocator, ctx->help_index);
+    ctx->help_index = NULL;
+}
+
+// case-insensitive order, a prefix sorts before words extending it
+int help_word_compare_(const char* a, int alen, const char* b, int blen) {
+    int n = alen < blen ? alen : blen;
+    for (int i=0; i<n; i++) {
+        int d = tolower((unsigned char)a[i]) - tolower((unsigned char)b[i]);
+        if (d) return d;
+    }
+    return alen - blen;
+}
+
+int help_word_compare_fn_(const void* a, const void* b) {
+    const help_word_t* x = (const help_word_t*)a;
+    const help_word_t* y = (const help_word_t*)b;
+    int d = help_word_compare_(x->word, x->len, y->word, y->len);
+    return d ? d : x->arginfo->id - y->arginfo->id;
+}
+
+// add alphanumeric runs of text as words of a parameter
+int help_index_add_words_(args_context_t* ctx, help_index_t* index, const char* text, arg_info_t* _a) {
+    while (text && *text) {
+        while (*text && !isalnum((unsigned char)*text)) text++;
+        const char* word = text;
+        while (isalnum((unsigned char)*text)) text++;
+        if (text == word) break;
+        if (index->count + 1 > index->capacity) {
+            int capacity = index->capacity ? index->capacity * 2 : 256;
+            help_word_t* _new = index->words ? ARGPARSE_REALLOC(&ctx->allocator, index->words, capacity * sizeof(help_word_t))
+                                             : ARGPARSE_MALLOC(&ctx->allocator, capacity * sizeof(help_word_t));
+            if (!_new) return FAIL;
+            index->words = (help_word_t*)_new;
+            index->capacity = capacity;
         }
-        int remain = ctx->help_leading_spaces - width;
-        for (int i=0; i<remain; i++)
-            fprintf(ctx->output_file, " ");
-        if (__a->description) {
-            print_line_wrap(ctx, __a->description, ctx->help_leading_spaces);
+        help_word_t* w = &index->words[index->count++];
+        w->word = word;
+        w->len = (int)(text - word);
+        w->arginfo = _a;
+    }
+    return OK;
+}
+
+help_index_t* help_index_get_(args_context_t* ctx) {
+    help_index_t* index = ctx->help_index;
+    if (index && index->parent == ctx->parent && index->args_count == args_count_(ctx) && index->id_holes == ctx->id_holes)
+        return index;
+    help_index_free_(ctx);
+    index = (help_index_t*)ARGPARSE_MALLOC(&ctx->allocator, sizeof(help_index_t));
+    if (!index) return NULL;
+    memset(index, 0, sizeof(help_index_t));
+    ctx->help_index = index;
+    for (args_context_t* c = ctx; c; c = c->parent) {
+        for (size_t i=0; i<c->args->size; i++) {
+            arg_info_t* _a = c->args->data[i];
+            if (help_index_add_words_(ctx, index, _a->long_term, _a) != OK
+                || help_index_add_words_(ctx, index, _a->help->description, _a) != OK) {
+                help_index_free_(ctx);
+                return NULL;
+            }
         }
-        fprintf(ctx->output_file, "\n");
     }
+    qsort(index->words, index->count, sizeof(help_word_t), help_word_compare_fn_);
+    index->parent = ctx->parent;
+    index->args_count = args_count_(ctx);
+    index->id_holes = ctx->id_holes;
+    return index;
+}
+
+// collect parameters of a trie subtree, all of their names start with the walked prefix
+int help_collect_subtree_(args_context_t* ctx, ctx_node_t* node, valarray_t* matches) {
+    if (node->_arg_sign == ACANE_SIGN && node->arg_info
+        && valarray_push_back(matches, node->arg_info) != OK)
+        return FAIL;
+    for (size_t i=0; i<node->children->size; i++)
+        if (help_collect_subtree_(ctx, node->children->data[i], matches) != OK)
+            return FAIL;
     return OK;
 }
 
+int help_compare_id_fn_(const void* a, const void* b) {
+    return (*(arg_info_t* const*)a)->id - (*(arg_info_t* const*)b)->id;
+}
+
+int argparse_print_help_matching(args_context_t* ctx, const char* pattern) {
+    if (!ctx || !pattern) return -1;
+    while (*pattern == '-') pattern++;
+    int plen = (int)strlen(pattern);
+    if (!plen)
+        return print_help_(ctx);
+    help_index_t* index = help_index_get_(ctx);
+    valarray_t* matches;
+    if (!index || valarray_init(&matches, &ctx->allocator) != OK)
+        return -1;
+    // names by prefix through the tries
+    for (args_context_t* c = ctx; c; c = c->parent) {
+        ctx_node_t* node = c->ctx_graph->head;
+        for (int i=0; node && i<plen; i++) {
+            int k = valarray_el_index_of(node->children, pattern[i]);
+            node = k < 0 ? NULL : node->children->data[k];
+        }
+        if (node && help_collect_subtree_(ctx, node, matches) != OK)
+            goto fail;
+    }
+    // words by prefix through the index, from the first word not ordered before the pattern
+    int lo = 0, hi = index->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (help_word_compare_(index->words[mid].word, index->words[mid].len, pattern, plen) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    for (int i=lo; i<index->count; i++) {
+        help_word_t* w = &index->words[i];
+        if (w->len < plen || help_word_compare_(w->word, plen, pattern, plen) != 0)
+            break;
+        if (valarray_push_back(matches, w->arginfo) != OK)
+            goto fail;
+    }
+    // render once each, in registration order
+    qsort(matches->data, matches->size, sizeof(void*), help_compare_id_fn_);
+    int count = 0;
+    for (size_t i=0; i<matches->size; i++) {
+        if (i && matches->data[i] == matches->data[i - 1])
+            continue;
+        print_help_entry_(ctx, matches->data[i]);
+        count++;
+    }
+    valarray_deinit(matches);
+    return count;
+
+fail:
+    valarray_deinit(matches);
+    return -1;
+}
+
 int argparse_print_help_for_positional(args_context_t* ctx) {
     if (!ctx) return FAIL;
     assert(ctx->positional_args->size == ctx->positional_args_description->size);
@@ -1074,22 +4585,17 @@ int argparse_print_help_for_positional(args_context_t* ctx) {
     return OK;
 }
 
-int argparse_compare_arginfo_fn(val_array_element_t a, val_array_element_t b) {
-    arg_info_t* __a = (arg_info_t*)a;
-    arg_info_t* __b = (arg_info_t*)b;
-    return strcmp(arg_info_to_string(__a), arg_info_to_string(__b)) < 0;
-}
-
 int argparse_sort_parameters(args_context_t* ctx) {
     if (!ctx) return FAIL;
-    valarray_sort(ctx->args, argparse_compare_arginfo_fn);
+    ctx->help_order = ARGPARSE_ORDER_ALPHABETICAL;
+    ctx->usage_order = ARGPARSE_ORDER_ALPHABETICAL;
     return OK;
 }
 
 #define MAX_USAGE_LEADING_SPACE 25
 #define FOREACH_ARG_START \
-for (int i=0; i<ctx->args->size; i++) {\
-    arg_info_t* __a = ctx->args->data[i];
+for (int i=0; i<_arg_count; i++) {\
+    arg_info_t* __a = _args[i];
 #define FOREACH_ARG_END    }
 #define PRINT_USAGE_(fmt, ...) _width += fprintf(ctx->output_file, fmt, ##__VA_ARGS__)
 #define PRINT_USAGE_LEADING_SPACE_() do {\
@@ -1098,6 +4604,9 @@ for (int i=0; i<ctx->args->size; i++) {\
     }\
 } while (0)
 int argparse_print_usage(args_context_t* ctx, const char* program_name) {
+    int _arg_count;
+    arg_info_t** _args = order_view_(ctx, ctx->usage_order, &_arg_count);
+    if (!_args) return FAIL;
     int pnlen = strlen(program_name) + strlen("usage: ") + 1;
     int leading_spaces = pnlen < MAX_USAGE_LEADING_SPACE ? pnlen : MAX_USAGE_LEADING_SPACE;
     LOG("LEADING SPACES=%d", leading_spaces);
@@ -1164,7 +4673,7 @@ int argparse_print_usage(args_context_t* ctx, const char* program_name) {
             // with arg
             if (__a->max_parameter_count > 0) {
                 // optional parameter
-                w += help_print_addi_parameters_name_to_str(__a, __a->arg_name, buf + w);
+                w += help_print_addi_parameters_name_to_str(__a, __a->help->arg_name, buf + w);
                 w += sprintf(buf + w, " ");
             }
             if (w + _width > max_width) {
@@ -1184,7 +4693,7 @@ int argparse_print_usage(args_context_t* ctx, const char* program_name) {
             // with arg
             if (__a->max_parameter_count > 0) {
                 // optional parameter
-                w += help_print_addi_parameters_name_to_str(__a, __a->arg_name, buf + w);
+                w += help_print_addi_parameters_name_to_str(__a, __a->help->arg_name, buf + w);
             }
             w += sprintf(buf + w, "] ");
             if (w + _width > max_width) {
@@ -1237,7 +4746,7 @@ int argparse_print_help_usage(args_context_t* ctx, const char* program_name, con
     // try print help for positional arguments
     int positional_count = 0;
     for (int i=0; i<ctx->positional_args_description->size; i++)
-        if (((arg_info_t*)ctx->positional_args_description->data[i])->description)
+        if (ctx->positional_args_description->data[i])
             positional_count++;
     if (positional_count) {
         fprintf(ctx->output_file, "%s:\n", title_for_position ? title_for_position : "Positional Arguments");
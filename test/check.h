@@ -0,0 +1,20 @@
+/*! \file check.h
+ *  Checks for the feature tests, each test is a program that returns non-zero on the first failed check.
+ */
+
+#ifndef _ACANE_ARGS_CHECK_H_
+#define _ACANE_ARGS_CHECK_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        return 1; \
+    } \
+} while (0)
+
+#define CHECK_STR(a, b) CHECK((a) && (b) && strcmp((a), (b)) == 0)
+
+#endif //_ACANE_ARGS_CHECK_H_
@@ -0,0 +1,46 @@
+// deferred actions: run after a successful parse only, by priority then argv order, once per parameter
+#include "args.h"
+#include "check.h"
+
+static char log_buf[128];
+
+static void record(args_context_t* ctx, int parac, const char** parav) {
+    strcat(log_buf, "[");
+    for (int i=0; i<parac; i++)
+        strcat(log_buf, parav[i]);
+    strcat(log_buf, "]");
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    CHECK(argparse_set_deferred_actions(ctx, 1));
+    argparse_add_parameter(ctx, "output", 'o', "output", 1, 1, 0, record);
+    argparse_add_parameter(ctx, "config", 'c', "config", 1, 1, 0, record);
+    CHECK(argparse_set_priority(ctx, 10));
+    argparse_add_parameter(ctx, "define", 'D', "define", 1, 2, 0, record);
+    argparse_add_parameter(ctx, "level", 'l', "level", 1, 1, 1, record);
+
+    // config first by priority, output before define by argv order, and define once with its last values
+    const char* argv[] = { "prog", "-o", "out", "-D", "a", "-c", "cfg", "-D", "b", "c", "-l", "1", NULL };
+    CHECK(parse_args(ctx, 12, argv));
+    CHECK_STR(log_buf, "[cfg][out][bc][1]");
+    int ids[8];
+    CHECK(argparse_get_action_order(ctx, ids, 8) == 4);
+    CHECK(ids[0] == argparse_get_parameter_id(ctx, "config"));
+    CHECK(ids[1] == argparse_get_parameter_id(ctx, "output"));
+    CHECK(ids[2] == argparse_get_parameter_id(ctx, "define"));
+    CHECK(ids[3] == argparse_get_parameter_id(ctx, "level"));
+
+    // the required level is missing: nothing runs
+    log_buf[0] = 0;
+    const char* missing[] = { "prog", "-o", "out", "-c", "cfg", NULL };
+    CHECK(!parse_args(ctx, 5, missing));
+    CHECK(log_buf[0] == 0);
+
+    // without deferring, callbacks run while parsing, before the error is found
+    CHECK(argparse_set_deferred_actions(ctx, 0));
+    CHECK(!parse_args(ctx, 5, missing));
+    CHECK_STR(log_buf, "[out][cfg]");
+    deinit_args_context(ctx);
+    return 0;
+}
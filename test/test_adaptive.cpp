@@ -0,0 +1,114 @@
+// adaptive lookup: frequent options move first in the name trie, counts persist as a profile
+#include "args.h"
+#include "check.h"
+
+#include <stdio.h>
+#include <string>
+#include <unistd.h>
+
+static std::string read_file(const std::string& path) {
+    std::string text;
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return text;
+    for (int c; (c = fgetc(f)) != EOF; )
+        text += (char)c;
+    fclose(f);
+    return text;
+}
+
+static args_context_t* make_context() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "alpha", 'a', "alpha", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "beta", 'b', "beta", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "gamma", 'g', "gamma", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    return ctx;
+}
+
+int main() {
+    const std::string base = "/tmp/argparse_test_profile_" + std::to_string(getpid());
+    const std::string first = base + "_1", second = base + "_2", third = base + "_3";
+    const char* argv[] = { "prog", "--verbose", "--gamma", "--verb", "--verbose", NULL };
+
+    // nothing is counted unless enabled
+    args_context_t* ctx = make_context();
+    CHECK(parse_args(ctx, 5, argv));
+    CHECK(argparse_save_lookup_profile(ctx, first.c_str()));
+    CHECK(read_file(first).empty());
+
+    // the most used edges come first, an abbreviation counts the edges it takes
+    CHECK(argparse_set_adaptive_lookup(ctx, 1));
+    CHECK(parse_args(ctx, 5, argv));
+    CHECK(argparse_save_lookup_profile(ctx, first.c_str()));
+    const std::string profile = read_file(first);
+    CHECK(profile.find("3 v\n3 ve\n3 ver\n3 verb\n2 verbo\n2 verbos\n2 verbose\n1 g\n") == 0);
+    CHECK(profile.find("1 gamma\n") != std::string::npos);
+    CHECK(profile.find(" a") == std::string::npos && profile.find(" b") == std::string::npos);
+    // lookups still resolve after reordering
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    CHECK(argparse_count(r, "verbose") == 3 && argparse_count(r, "gamma") == 1);
+    argparse_parse_result_deinit(r);
+    CHECK(argparse_set_adaptive_lookup(ctx, 0));
+    CHECK(parse_args(ctx, 5, argv));
+    CHECK(argparse_save_lookup_profile(ctx, second.c_str()));
+    CHECK(read_file(second) == profile);
+    deinit_args_context(ctx);
+
+    // a loaded profile reorders a fresh context the same way and saves back unchanged
+    ctx = make_context();
+    CHECK(argparse_load_lookup_profile(ctx, first.c_str()));
+    CHECK(argparse_save_lookup_profile(ctx, second.c_str()));
+    CHECK(read_file(second) == profile);
+    // loading again adds the counts
+    CHECK(argparse_load_lookup_profile(ctx, first.c_str()));
+    CHECK(argparse_save_lookup_profile(ctx, second.c_str()));
+    CHECK(read_file(second).find("6 v\n") == 0);
+    deinit_args_context(ctx);
+
+    // prefixes unknown to the context are skipped, a missing file fails
+    FILE* f = fopen(third.c_str(), "w");
+    fprintf(f, "9 zeta\n4 b\nnot a line\n");
+    fclose(f);
+    ctx = make_context();
+    CHECK(argparse_load_lookup_profile(ctx, third.c_str()));
+    CHECK(argparse_save_lookup_profile(ctx, second.c_str()));
+    CHECK(read_file(second) == "4 b\n");
+    CHECK(!argparse_load_lookup_profile(ctx, (base + "_missing").c_str()));
+    deinit_args_context(ctx);
+
+    // unknown and ambiguous names are not counted
+    ctx = make_context();
+    argparse_add_parameter(ctx, "verify", 0, "verify", 0, 0, 0, NULL);
+    argparse_set_error_handle_ex(ctx, [](args_context_t*, const argparse_error_t*, void*) { return 0; }, NULL);
+    CHECK(argparse_set_adaptive_lookup(ctx, 1));
+    const char* unknown[] = { "prog", "--verbx", NULL };
+    const char* ambiguous[] = { "prog", "--ver", NULL };
+    CHECK(!parse_args(ctx, 2, unknown));
+    CHECK(!parse_args(ctx, 2, ambiguous));
+    CHECK(argparse_save_lookup_profile(ctx, second.c_str()));
+    CHECK(read_file(second).empty());
+    deinit_args_context(ctx);
+
+    // derived contexts look names up through their parent, which does not adapt while they exist
+    ctx = make_context();
+    args_context_t* child = argparse_derive_context(ctx);
+    CHECK(!argparse_set_adaptive_lookup(ctx, 1));
+    CHECK(!argparse_load_lookup_profile(ctx, first.c_str()));
+    CHECK(argparse_set_adaptive_lookup(child, 1));
+    deinit_args_context(child);
+    CHECK(argparse_set_adaptive_lookup(ctx, 1));
+    deinit_args_context(ctx);
+
+    // spec versions are shared with readers and never adapt
+    argparse_spec_t* spec = argparse_spec_init(NULL);
+    args_context_t* draft = argparse_spec_edit(spec);
+    CHECK(!argparse_set_adaptive_lookup(draft, 1));
+    CHECK(!argparse_load_lookup_profile(draft, first.c_str()));
+    argparse_spec_discard(spec);
+    argparse_spec_deinit(spec);
+
+    unlink(first.c_str());
+    unlink(second.c_str());
+    unlink(third.c_str());
+    return 0;
+}
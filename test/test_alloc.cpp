@@ -0,0 +1,85 @@
+// allocator hooks: every block of a context and its results comes from the hooks
+#include "args.h"
+#include "check.h"
+
+#include <stdlib.h>
+
+struct counter {
+    int allocations;
+    int live;
+    int foreign;    // blocks freed or resized through the hooks that they did not allocate
+};
+
+// blocks carry a tag in front, so a block not made by the hooks is noticed
+static const size_t TAG = 0x7a11c47e;
+static const size_t HEADER = 16;
+
+static void* tag_(counter* c, void* raw) {
+    if (!raw) return NULL;
+    *(size_t*)raw = TAG;
+    c->allocations++;
+    return (char*)raw + HEADER;
+}
+
+static void* raw_(counter* c, void* ptr) {
+    char* raw = (char*)ptr - HEADER;
+    if (*(size_t*)raw != TAG) {
+        c->foreign++;
+        return NULL;
+    }
+    return raw;
+}
+
+static void* count_allocate(void* user, size_t size) {
+    counter* c = (counter*)user;
+    void* p = tag_(c, malloc(size + HEADER));
+    if (p) c->live++;
+    return p;
+}
+
+static void* count_reallocate(void* user, void* ptr, size_t size) {
+    counter* c = (counter*)user;
+    if (!ptr) return count_allocate(user, size);
+    void* raw = raw_(c, ptr);
+    if (!raw) return NULL;
+    return tag_(c, realloc(raw, size + HEADER));
+}
+
+static void count_deallocate(void* user, void* ptr) {
+    counter* c = (counter*)user;
+    if (!ptr) return;
+    void* raw = raw_(c, ptr);
+    if (!raw) return;
+    *(size_t*)raw = 0;
+    c->live--;
+    free(raw);
+}
+
+int main() {
+    counter c = { 0, 0, 0 };
+    argparse_allocator_t a = { count_allocate, count_reallocate, count_deallocate, &c };
+    args_context_t* ctx = init_args_context_with_allocator(&a);
+    CHECK(ctx);
+    CHECK(c.allocations > 0);
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 3, 0, NULL);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 10);
+    int before = c.allocations;
+    const char* argv[] = { "prog", "-vv", "--name", "a", "b", "c", "x", "y", NULL };
+    for (int i=0; i<3; i++)
+        CHECK(parse_args(ctx, 8, argv));
+    CHECK(c.allocations > before);
+    // a result taken by the caller is freed through the hooks too
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    CHECK(r);
+    argparse_parse_result_deinit(r);
+    CHECK(parse_args(ctx, 8, argv));
+    deinit_args_context(ctx);
+    CHECK(c.foreign == 0);
+    CHECK(c.live == 0);
+
+    // a failing allocator fails the context instead of crashing
+    argparse_allocator_t none = { [](void*, size_t) -> void* { return NULL; }, count_reallocate, count_deallocate, &c };
+    CHECK(!init_args_context_with_allocator(&none));
+    return 0;
+}
@@ -0,0 +1,86 @@
+// positional batches: runs of consecutive positional args in one call, split by options
+#include "args.h"
+#include "check.h"
+
+#include <string.h>
+#include <vector>
+
+struct run {
+    int first_index;
+    int count;
+    const char** args;
+};
+static std::vector<run> runs;
+
+static void on_batch(int first_index, int count, const char** args) {
+    runs.push_back({ first_index, count, args });
+}
+
+static int directive_index = -1;
+
+// takes the rest of argv from "stop" on
+static int on_directive(int index, int argc, const char** argv) {
+    if (strcmp(argv[0], "stop") != 0)
+        return 0;
+    directive_index = index;
+    return 1;
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 10);
+    argparse_set_positional_batch_process(ctx, on_batch);
+    const char* argv[] = { "prog", "a", "b", "-v", "c", "--name", "x", "d", "e", NULL };
+    CHECK(parse_args(ctx, 9, argv));
+
+    // runs are split by options, args point into argv
+    CHECK(runs.size() == 3);
+    CHECK(runs[0].first_index == 0 && runs[0].count == 2 && runs[0].args == argv + 1);
+    CHECK(runs[1].first_index == 2 && runs[1].count == 1 && runs[1].args == argv + 4);
+    CHECK(runs[2].first_index == 3 && runs[2].count == 2 && runs[2].args == argv + 7);
+
+    // the result keeps every positional arg in order
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    int count = 0;
+    const char** positionals = argparse_get_positionals(r, &count);
+    CHECK(count == 5);
+    const int expected[] = { 1, 2, 4, 7, 8 };
+    for (int i=0; i<5; i++)
+        CHECK(positionals[i] == argv[expected[i]]);
+    argparse_parse_result_deinit(r);
+
+    // no positional args, no call
+    runs.clear();
+    const char* only_options[] = { "prog", "-v", "--name", "x", NULL };
+    CHECK(parse_args(ctx, 4, only_options));
+    CHECK(runs.empty());
+    r = argparse_get_last_parse_result(ctx);
+    argparse_get_positionals(r, &count);
+    CHECK(count == 0);
+    argparse_parse_result_deinit(r);
+
+    // a directive declining an arg does not split the run, the run is delivered once a directive ends the parse
+    runs.clear();
+    argparse_set_directive_positional_arg_process(ctx, on_directive);
+    const char* directive[] = { "prog", "a", "b", "stop", "c", NULL };
+    CHECK(parse_args(ctx, 5, directive));
+    CHECK(directive_index == 2);
+    CHECK(runs.size() == 1);
+    CHECK(runs[0].first_index == 0 && runs[0].count == 2 && runs[0].args == directive + 1);
+    deinit_args_context(ctx);
+
+    // a parse stopped by an error still delivers the pending run
+    ctx = init_args_context();
+    argparse_set_error_handle_ex(ctx, [](args_context_t*, const argparse_error_t*, void*) { return 0; }, NULL);
+    argparse_set_positional_args(ctx, 0, 2);
+    argparse_set_positional_batch_process(ctx, on_batch);
+    runs.clear();
+    const char* too_many[] = { "prog", "a", "b", "c", NULL };
+    CHECK(!parse_args(ctx, 4, too_many));
+    CHECK(runs.size() == 1);
+    CHECK(runs[0].first_index == 0 && runs[0].count == 2 && runs[0].args == too_many + 1);
+    deinit_args_context(ctx);
+    return 0;
+}
@@ -0,0 +1,96 @@
+// bound fields: values are converted into a struct while parsing, string bindings of views get copies
+#include "args.h"
+#include "check.h"
+
+struct config {
+    int port;
+    double ratio;
+    const char* host;
+    int color;
+    int verbosity;
+    std::string user;
+    std::vector<long> ids;
+};
+
+int main() {
+    config cfg = { 0, 0, NULL, 0, 0 };
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "port", 'p', "port", 1, 1, 0, NULL);
+    argparse_bind(ctx, &cfg.port, argparse_convert_int);
+    argparse_add_parameter(ctx, "ratio", 'r', "ratio", 1, 1, 0, NULL);
+    argparse_bind(ctx, &cfg.ratio, argparse_convert_double);
+    argparse_add_parameter(ctx, "host", 'h', "host", 1, 1, 0, NULL);
+    argparse::bind<&config::host>(ctx, cfg);
+    argparse_add_parameter(ctx, "color", 0, "color", 0, 1, 0, NULL);
+    argparse_bind(ctx, &cfg.color, argparse_convert_flag);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_bind(ctx, &cfg.verbosity, argparse_convert_count);
+    argparse_add_parameter(ctx, "user", 'u', "user", 1, 1, 0, NULL);
+    argparse::bind<&config::user>(ctx, cfg);
+    argparse_add_parameter(ctx, "id", 'i', "ids", 1, 3, 0, NULL);
+    argparse::bind<&config::ids>(ctx, cfg);
+    uint64_t presence[ARGPARSE_BITSET_WORDS(7)];
+    int counts[7];
+    CHECK(argparse_bind_presence(ctx, presence, counts));
+
+    const char* argv[] = { "prog", "-p", "0x50", "--ratio=0.5", "-h", "example", "--color=off", "-vvv", "-u", "root",
+                           "-i", "1", "2", "3", NULL };
+    CHECK(parse_args(ctx, 14, argv));
+    CHECK(cfg.port == 80 && cfg.ratio == 0.5 && cfg.color == 0 && cfg.verbosity == 3);
+    CHECK(cfg.host == argv[5]);
+    CHECK(cfg.user == "root");
+    CHECK(cfg.ids.size() == 3 && cfg.ids[2] == 3);
+    const int port = argparse_get_parameter_id(ctx, "port");
+    const int user = argparse_get_parameter_id(ctx, "user");
+    CHECK((presence[0] >> port & 1) && counts[port] == 1);
+    CHECK(counts[argparse_get_parameter_id(ctx, "verbose")] == 3);
+
+    // views are not NUL-terminated, converters stop at the length of the value
+    char port_buf[] = "--port=8080123";
+    const argparse_view_t port_views[] = { { "prog", 4 }, { port_buf, 11 } };
+    CHECK(parse_args_views(ctx, 2, port_views));
+    CHECK(cfg.port == 8080);
+    // and the bound string is a terminated copy that outlives the buffer
+    char buf[] = "--host=localhostXYZ";
+    const argparse_view_t views[] = { { "prog", 4 }, { buf, 16 } };
+    CHECK(parse_args_views(ctx, 2, views));
+    memset(buf, '#', sizeof(buf) - 1);
+    CHECK_STR(cfg.host, "localhost");
+    CHECK(!(presence[0] >> user & 1) && counts[user] == 0);
+
+    // an optional value left out converts like a flag, before another option and at the end
+    const char* color_then_flag[] = { "prog", "--color", "-v", NULL };
+    CHECK(parse_args(ctx, 3, color_then_flag));
+    CHECK(cfg.color == 1 && cfg.verbosity == 4);
+    cfg.color = 0;
+    const char* color_last[] = { "prog", "-v", "--color", NULL };
+    CHECK(parse_args(ctx, 3, color_last));
+    CHECK(cfg.color == 1);
+    cfg.color = 0;
+    const argparse_view_t color_views[] = { { "prog", 4 }, { "--color", 7 } };
+    CHECK(parse_args_views(ctx, 2, color_views));
+    CHECK(cfg.color == 1);
+
+    // rejected values are reported with the offending text
+    argparse_set_collect_errors(ctx, 1);
+    const char* bad[] = { "prog", "--port=80x", "--color=maybe", NULL };
+    CHECK(!parse_args(ctx, 3, bad));
+    int count = 0;
+    const argparse_error_t* e = argparse_get_errors(ctx, &count);
+    CHECK(count == 2 && e[0].code == ARGPARSE_ERROR_INVALID_VALUE && e[0].option == port && e[0].offset == 7);
+    CHECK_STR(e[1].text, "maybe");
+    deinit_args_context(ctx);
+
+    // a converter rejecting the missing value of a flag stops the parse
+    int strict = 0;
+    ctx = init_args_context();
+    argparse_set_error_handle_ex(ctx, [](args_context_t*, const argparse_error_t*, void*) { return 0; }, NULL);
+    argparse_add_parameter(ctx, "strict", 's', "strict", 0, 0, 0, NULL);
+    argparse_bind(ctx, &strict, [](void*, const char* value, size_t) { return value ? 1 : 0; });
+    const char* flag[] = { "prog", "-s", NULL };
+    CHECK(!parse_args(ctx, 2, flag));
+    e = argparse_get_errors(ctx, &count);
+    CHECK(count == 1 && e[0].code == ARGPARSE_ERROR_INVALID_VALUE && e[0].argv_index == 1);
+    deinit_args_context(ctx);
+    return 0;
+}
@@ -0,0 +1,51 @@
+// choices: values resolve to their index through a trie, unique prefixes are accepted
+#include "args.h"
+#include "check.h"
+
+static int last_code = ARGPARSE_ERROR_NONE;
+
+static int record(args_context_t* ctx, const argparse_error_t* err, void* user) {
+    last_code = err->code;
+    return 0;
+}
+
+// index of the choice `value` resolves to, -1 if rejected (the code is left in last_code)
+static int choose(args_context_t* ctx, const char* value) {
+    const char* argv[] = { "prog", "--level", value, NULL };
+    last_code = ARGPARSE_ERROR_NONE;
+    if (!parse_args(ctx, 3, argv))
+        return -1;
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    int choice = argparse_get_choice(r, "level");
+    argparse_parse_result_deinit(r);
+    return choice;
+}
+
+int main() {
+    static const char* const levels[] = { "debug", "info", "warn", "warning", "error", "emergency" };
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "level", 'l', "log level", 1, 1, 0, NULL);
+    CHECK(argparse_set_choices(ctx, levels, 6));
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, NULL);
+    argparse_set_error_handle_ex(ctx, record, NULL);
+
+    CHECK(choose(ctx, "info") == 1);
+    CHECK(choose(ctx, "error") == 4);
+    CHECK(choose(ctx, "deb") == 0);
+    // an exact match wins over a longer choice sharing the prefix
+    CHECK(choose(ctx, "warn") == 2);
+    CHECK(choose(ctx, "warni") == 3);
+    CHECK(choose(ctx, "e") == -1 && last_code == ARGPARSE_ERROR_AMBIGUOUS_CHOICE);
+    CHECK(choose(ctx, "trace") == -1 && last_code == ARGPARSE_ERROR_INVALID_CHOICE);
+    CHECK(choose(ctx, "debugx") == -1 && last_code == ARGPARSE_ERROR_INVALID_CHOICE);
+
+    // inline values are checked too, parameters without choices report -1
+    const char* argv[] = { "prog", "--level=inf", "-n", "x", NULL };
+    CHECK(parse_args(ctx, 4, argv));
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    CHECK(argparse_get_choice(r, "level") == 1);
+    CHECK(argparse_get_choice(r, "name") == -1);
+    argparse_parse_result_deinit(r);
+    deinit_args_context(ctx);
+    return 0;
+}
@@ -0,0 +1,73 @@
+// bitset constraints: exclusive, requires, at-least-one and occurrence limits, across more than 64 parameters
+#include "args.h"
+#include "check.h"
+
+static char names[70][8];
+
+// errors are read from argparse_get_errors(), nothing to print
+static int quiet(args_context_t* ctx, const argparse_error_t* err, void* user) {
+    return 0;
+}
+
+// code of the first error of parsing `line`, ARGPARSE_ERROR_NONE if it passes
+static int first_error(args_context_t* ctx, const char* const* line) {
+    const char* argv[8] = { "prog" };
+    int argc = 1;
+    while (line[argc - 1]) {
+        argv[argc] = line[argc - 1];
+        argc++;
+    }
+    if (parse_args(ctx, argc, argv))
+        return ARGPARSE_ERROR_NONE;
+    int count = 0;
+    const argparse_error_t* e = argparse_get_errors(ctx, &count);
+    return count ? e[0].code : -1;
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_set_error_handle_ex(ctx, quiet, NULL);
+    // ids 0..69, so masks span two words
+    for (int i=0; i<70; i++) {
+        snprintf(names[i], sizeof(names[i]), "p%d", i);
+        argparse_add_parameter(ctx, names[i], 0, "parameter", 0, 0, 0, NULL);
+    }
+    const int exclusive[] = { 1, 68 };
+    const int requires_[] = { 2, 66, 67 };
+    const int at_least_one[] = { 3, 69 };
+    CHECK(argparse_add_constraint(ctx, ARGPARSE_CONSTRAINT_MUTUALLY_EXCLUSIVE, exclusive, 2));
+    CHECK(argparse_add_constraint(ctx, ARGPARSE_CONSTRAINT_REQUIRES, requires_, 3));
+    CHECK(argparse_add_constraint(ctx, ARGPARSE_CONSTRAINT_AT_LEAST_ONE, at_least_one, 2));
+    CHECK(argparse_set_occurrence_limit(ctx, 0, 0, 2));
+    // occurrence limits have their own setter, requires needs a dependency
+    CHECK(!argparse_add_constraint(ctx, ARGPARSE_CONSTRAINT_OCCURRENCE, exclusive, 2));
+    CHECK(!argparse_add_constraint(ctx, ARGPARSE_CONSTRAINT_REQUIRES, requires_, 1));
+
+    static const struct {
+        const char* line[6];
+        int error;
+    } cases[] = {
+        { { "--p3", NULL }, ARGPARSE_ERROR_NONE },
+        { { "--p69", "--p1", NULL }, ARGPARSE_ERROR_NONE },
+        { { NULL }, ARGPARSE_ERROR_AT_LEAST_ONE },
+        { { "--p3", "--p1", "--p68", NULL }, ARGPARSE_ERROR_MUTUALLY_EXCLUSIVE },
+        { { "--p3", "--p2", "--p66", NULL }, ARGPARSE_ERROR_REQUIRES },
+        { { "--p3", "--p2", "--p66", "--p67", NULL }, ARGPARSE_ERROR_NONE },
+        { { "--p3", "--p0", "--p0", NULL }, ARGPARSE_ERROR_NONE },
+        { { "--p3", "--p0", "--p0", "--p0", NULL }, ARGPARSE_ERROR_OCCURRENCE },
+    };
+    for (size_t i=0; i<sizeof(cases) / sizeof(cases[0]); i++) {
+        if (first_error(ctx, cases[i].line) != cases[i].error) {
+            fprintf(stderr, "case %zu: error %d, expected %d\n", i, first_error(ctx, cases[i].line), cases[i].error);
+            return 1;
+        }
+    }
+
+    // the error names the parameters involved
+    const char* line[] = { "--p3", "--p2", NULL };
+    CHECK(first_error(ctx, line) == ARGPARSE_ERROR_REQUIRES);
+    const argparse_error_t* e = argparse_get_errors(ctx, NULL);
+    CHECK(e->option == 2 && (e->count == 66 || e->count == 67));
+    deinit_args_context(ctx);
+    return 0;
+}
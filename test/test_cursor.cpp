@@ -0,0 +1,50 @@
+// pull parser: events in argv order, values attached to their option, no callbacks and no result
+#include "args.h"
+#include "check.h"
+
+static int callbacks = 0;
+
+static void count_callback(args_context_t* ctx, int parac, const char** parav) {
+    callbacks++;
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "level", 'l', "level", 1, 2, 0, count_callback);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, count_callback);
+    argparse_add_parameter(ctx, "name", 0, "name", 1, 1, 0, count_callback);
+    argparse_set_positional_args(ctx, 0, 1);
+    argparse_enable_remove_ambiguous(ctx);
+    const char* argv[] = { "prog", "-vl", "a", "b", "x", "--name=z", "--", "--nope", "y", NULL };
+
+    argparse_cursor_t cur;
+    argparse_event_t ev;
+    CHECK(argparse_cursor_init(&cur, ctx, 9, argv));
+
+    // -v of the combined -vl takes no values
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_OPTION);
+    CHECK(ev.short_term == 'v' && ev.parac == 0 && ev.index == 1);
+    // -l is the last flag of the cluster, it takes up to two values
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_OPTION);
+    CHECK_STR(ev.long_term, "level");
+    CHECK(ev.parac == 2);
+    CHECK_STR(ev.parav[0], "a");
+    CHECK_STR(ev.parav[1], "b");
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_POSITIONAL);
+    CHECK(ev.index == 4 && ev.positional_index == 0);
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_OPTION);
+    CHECK(ev.parac == 1);
+    CHECK_STR(ev.parav[0], "z");
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_SEPARATOR);
+    // errors are events, the cursor goes on after them
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_ERROR);
+    CHECK(ev.index == 7 && strstr(ev.message, "nope"));
+    CHECK(argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_ERROR);
+    CHECK(ev.index == 8 && strstr(ev.message, "positional"));
+    CHECK(!argparse_cursor_next(&cur, &ev) && ev.type == ARGPARSE_EVENT_END);
+
+    CHECK(callbacks == 0);
+    CHECK(argparse_get_last_parse_result(ctx) == NULL);
+    deinit_args_context(ctx);
+    return 0;
+}
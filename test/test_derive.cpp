@@ -0,0 +1,55 @@
+// derived contexts: subcommands inherit the parent's parameters without copying them
+#include "args.h"
+#include "check.h"
+
+static int verbose_calls = 0;
+
+static void on_verbose(args_context_t* ctx, int parac, const char** parav) {
+    verbose_calls++;
+}
+
+int main() {
+    args_context_t* root = init_args_context();
+    argparse_add_parameter(root, "verbose", 'v', "verbose", 0, 0, 0, on_verbose);
+    argparse_add_parameter(root, "config", 'c', "config", 1, 1, 0, NULL);
+    args_context_t* sub = argparse_derive_context(root);
+    argparse_add_parameter(sub, "force", 'f', "force", 0, 0, 0, NULL);
+    args_context_t* leaf = argparse_derive_context(sub);
+    argparse_add_parameter(leaf, "all", 'a', "all", 0, 0, 0, NULL);
+
+    // the parent is frozen and inherited names are taken
+    CHECK(!argparse_add_parameter(root, "late", 0, "late", 0, 0, 0, NULL));
+    CHECK(!argparse_add_parameter(leaf, "config", 0, "again", 0, 0, 0, NULL));
+    // ids continue along the chain
+    CHECK(argparse_get_parameter_id(leaf, "verbose") == 0);
+    CHECK(argparse_get_parameter_id(leaf, "force") == 2);
+    CHECK(argparse_get_parameter_id(leaf, "all") == 3);
+    CHECK(argparse_get_parameter_id(sub, "all") == -1);
+
+    // parameters of every ancestor resolve, abbreviated and combined too
+    const char* argv[] = { "prog", "--verb", "--conf=a.ini", "-fa", NULL };
+    CHECK(parse_args(leaf, 4, argv));
+    parse_result_t* r = argparse_get_last_parse_result(leaf);
+    parsed_argument_t a;
+    CHECK(argparse_get_parsed_arg(r, "config", &a) && a.parac == 1);
+    CHECK_STR(a.parav[0], "a.ini");
+    CHECK(argparse_count(r, "force") == 1 && argparse_count(r, "all") == 1);
+    argparse_parse_result_deinit(r);
+    CHECK(verbose_calls == 1);
+    // the sibling level does not see parameters of its children
+    CHECK(!parse_args(sub, 4, argv));
+
+    // only own parameters are allocated
+    argparse_memory_stats_t s;
+    CHECK(argparse_get_memory_stats(leaf, &s));
+    CHECK(s.arg_info_count == 1);
+
+    // a parent outlives its children, deinit is refused until they are gone
+    deinit_args_context(root);
+    CHECK(argparse_get_parameter_id(root, "config") == 1);
+    deinit_args_context(leaf);
+    deinit_args_context(sub);
+    CHECK(argparse_add_parameter(root, "late", 0, "late", 0, 0, 0, NULL));
+    deinit_args_context(root);
+    return 0;
+}
@@ -0,0 +1,39 @@
+// structured errors: collected in one pass with argv index and offset, formatted only on request
+#include "args.h"
+#include "check.h"
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 1, NULL);
+    argparse_set_collect_errors(ctx, 1);
+    const char* argv[] = { "prog", "-vx", "--verbose=3", "-v=4", "--nope", NULL };
+    CHECK(!parse_args(ctx, 5, argv));
+
+    int count = 0;
+    const argparse_error_t* e = argparse_get_errors(ctx, &count);
+    CHECK(count == 5);
+    CHECK(e[0].code == ARGPARSE_ERROR_UNKNOWN_OPTION && e[0].argv_index == 1 && e[0].offset == 2);
+    // a flag without parameters rejects an inline value, the offset is the one of the value
+    CHECK(e[1].code == ARGPARSE_ERROR_UNEXPECTED_VALUE && e[1].argv_index == 2 && e[1].offset == 10);
+    CHECK(e[1].option == argparse_get_parameter_id(ctx, "verbose"));
+    CHECK(e[2].code == ARGPARSE_ERROR_UNEXPECTED_VALUE && e[2].argv_index == 3 && e[2].offset == 3);
+    CHECK(e[3].code == ARGPARSE_ERROR_UNKNOWN_OPTION && e[3].argv_index == 4);
+    CHECK(e[4].code == ARGPARSE_ERROR_MISSING_REQUIRED && e[4].option == argparse_get_parameter_id(ctx, "name"));
+
+    char buf[64];
+    CHECK(argparse_format_error(ctx, &e[1], buf, sizeof(buf)) > 0);
+    CHECK_STR(buf, "--verbose does not take a value '3'");
+    // like snprintf, the full length is returned even if truncated
+    char small[8];
+    CHECK(argparse_format_error(ctx, &e[1], small, sizeof(small)) == (int)strlen(buf));
+    CHECK(strlen(small) == sizeof(small) - 1);
+
+    // without collecting, parsing stops at the first error
+    argparse_set_collect_errors(ctx, 0);
+    CHECK(!parse_args(ctx, 5, argv));
+    e = argparse_get_errors(ctx, &count);
+    CHECK(count == 1 && e[0].code == ARGPARSE_ERROR_UNKNOWN_OPTION && e[0].argv_index == 1);
+    deinit_args_context(ctx);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// help search: entries matching a name prefix or a word of a description, and --help=<pattern>
+#include "args.h"
+#include "check.h"
+
+#include <stdlib.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static FILE* out;
+
+// help printed by `pattern`, count of entries in `count`
+static std::string search(args_context_t* ctx, const char* pattern, int* count) {
+    rewind(out);
+    ftruncate(fileno(out), 0);
+    *count = argparse_print_help_matching(ctx, pattern);
+    fflush(out);
+    std::string text;
+    rewind(out);
+    for (int c; (c = fgetc(out)) != EOF; )
+        text += (char)c;
+    return text;
+}
+
+static int directive_parac = -1;
+static const char** directive_parav = NULL;
+
+static void on_add(args_context_t* ctx, int parac, const char** parav) {
+    directive_parac = parac;
+    directive_parav = parav;
+}
+
+int main() {
+    out = tmpfile();
+    args_context_t* ctx = init_args_context();
+    argparse_set_print_file(ctx, out);
+    argparse_add_help_parameter(ctx, "prog", NULL);
+    argparse_add_parameter(ctx, "verbose", 'v', "Print more details", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "dry-run", 'n', "Show what would be done", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "output", 'o', "Write the REPORT to a file", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "report", 'r', "Report format", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "verify", 0, "Check the signature", 0, 0, 0, NULL);
+
+    int count = 0;
+    // names by prefix, leading dashes ignored
+    std::string text = search(ctx, "--ver", &count);
+    CHECK(count == 2);
+    CHECK(text.find("--verbose") != std::string::npos && text.find("--verify") != std::string::npos);
+    CHECK(text.find("--output") == std::string::npos);
+    // words of names and descriptions ignore case, a parameter matching twice is printed once
+    text = search(ctx, "REPORT", &count);
+    CHECK(count == 2);
+    CHECK(text.find("--report") == text.rfind("--report") && text.find("--output") != std::string::npos);
+    CHECK(search(ctx, "run", &count).find("--dry-run") != std::string::npos && count == 1);
+    CHECK(search(ctx, "signa", &count).find("--verify") != std::string::npos && count == 1);
+    search(ctx, "zzz", &count);
+    CHECK(count == 0);
+    CHECK(argparse_print_help_matching(ctx, NULL) == -1);
+
+    // the index follows added parameters
+    argparse_add_parameter(ctx, "signature", 's', "Signing key", 1, 1, 0, NULL);
+    search(ctx, "signa", &count);
+    CHECK(count == 2);
+
+    // an empty pattern prints the whole help and counts the entries printed
+    text = search(ctx, "--", &count);
+    CHECK(count == 7);
+    CHECK(text.find("--help") != std::string::npos && text.find("--signature") != std::string::npos);
+    // inherited parameters are printed and counted too
+    args_context_t* child = argparse_derive_context(ctx);
+    argparse_set_print_file(child, out);
+    argparse_add_parameter(child, "extra", 'x', "Extra work", 0, 0, 0, NULL);
+    text = search(child, "", &count);
+    CHECK(count == 8);
+    CHECK(text.find("--extra") != std::string::npos && text.find("--dry-run") != std::string::npos);
+    search(child, "ver", &count);
+    CHECK(count == 2);
+    deinit_args_context(child);
+
+    // --help=<pattern> prints the matches and exits
+    fflush(out);
+    pid_t pid = fork();
+    if (pid == 0) {
+        rewind(out);
+        ftruncate(fileno(out), 0);
+        const char* argv[] = { "prog", "-v", "--help=dry", "--output", NULL };
+        parse_args(ctx, 4, argv);
+        _exit(3);
+    }
+    int status = 0;
+    CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    text.clear();
+    rewind(out);
+    for (int c; (c = fgetc(out)) != EOF; )
+        text += (char)c;
+    CHECK(text.find("--dry-run") != std::string::npos && text.find("--verbose") == std::string::npos);
+
+    // a directive without values takes the rest of argv, itself first, and ends the parse
+    argparse_add_parameter_directive(ctx, "add", 0, "add files", 0, on_add);
+    const char* argv[] = { "prog", "-v", "--add", "-x", "y", NULL };
+    CHECK(parse_args(ctx, 5, argv));
+    CHECK(directive_parac == 3 && directive_parav == argv + 2);
+    deinit_args_context(ctx);
+    fclose(out);
+    return 0;
+}
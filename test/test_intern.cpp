@@ -0,0 +1,61 @@
+// owned strings: generated names and descriptions are copied, equal strings are stored once
+#include "args.h"
+#include "check.h"
+
+#include <string>
+
+#define COUNT 200
+
+// register COUNT parameters from a scratch buffer that is wiped afterwards
+static args_context_t* generate(int shared_description) {
+    args_context_t* ctx = init_args_context();
+    if (!argparse_set_owned_strings(ctx, 1)) return NULL;
+    char name[16];
+    for (int i=0; i<COUNT; i++) {
+        snprintf(name, sizeof(name), "gen-%d", i);
+        std::string description = (shared_description ? "" : name) + std::string(1000, 'd');
+        argparse_add_parameter(ctx, name, 0, description.c_str(), 1, 1, 0, NULL);
+        memset(name, 'x', sizeof(name) - 1);
+    }
+    return ctx;
+}
+
+int main() {
+    args_context_t* shared = generate(1);
+    args_context_t* distinct = generate(0);
+    CHECK(shared && distinct);
+    argparse_memory_stats_t s, d;
+    CHECK(argparse_get_memory_stats(shared, &s) && argparse_get_memory_stats(distinct, &d));
+    // one copy of the shared description instead of COUNT
+    CHECK(s.string_bytes < 16 * 1024);
+    CHECK(d.string_bytes > COUNT * 1000);
+
+    // copies stay valid after the buffers were wiped
+    char value[] = "v";
+    const char* argv[] = { "prog", "--gen-123", value, NULL };
+    CHECK(parse_args(shared, 3, argv));
+    FILE* out = tmpfile();
+    argparse_set_print_file(distinct, out);
+    CHECK(argparse_print_help(distinct));
+    static char help[1024 * 1024];
+    size_t n = fread(help, 1, sizeof(help) - 1, (rewind(out), out));
+    help[n] = 0;
+    CHECK(strstr(help, "--gen-199") && strstr(help, "gen-199d"));
+    fclose(out);
+
+    // choices are copied too
+    const char* choices[] = { strdup("fast"), strdup("slow") };
+    argparse_add_parameter(shared, "mode", 0, "mode", 1, 1, 0, NULL);
+    CHECK(argparse_set_choices(shared, choices, 2));
+    free((void*)choices[0]);
+    free((void*)choices[1]);
+    const char* mode[] = { "prog", "--mode", "sl", NULL };
+    CHECK(parse_args(shared, 3, mode));
+    parse_result_t* r = argparse_get_last_parse_result(shared);
+    CHECK(argparse_get_choice(r, "mode") == 1);
+    argparse_parse_result_deinit(r);
+
+    deinit_args_context(shared);
+    deinit_args_context(distinct);
+    return 0;
+}
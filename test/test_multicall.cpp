@@ -0,0 +1,62 @@
+// multi-call dispatch: applets are selected by argv[0] or argv[1], and only selected ones are built
+#include "args.h"
+#include "check.h"
+
+static int setups = 0;
+
+static int setup_ls(args_context_t* ctx, void* user) {
+    setups++;
+    return argparse_add_parameter(ctx, "long", 'l', "long listing", 0, 0, 0, NULL);
+}
+
+static int setup_other(args_context_t* ctx, void* user) {
+    setups++;
+    return user != NULL;
+}
+
+int main() {
+    argparse_multicall_t* mc = argparse_multicall_init(NULL);
+    CHECK(argparse_multicall_register(mc, "ls", setup_ls, NULL));
+    CHECK(!argparse_multicall_register(mc, "ls", setup_ls, NULL));
+    CHECK(argparse_multicall_register(mc, "broken", setup_other, NULL));
+    // enough applets to grow the registry a few times
+    static char names[100][8];
+    for (int i=0; i<100; i++) {
+        snprintf(names[i], sizeof(names[i]), "cmd%d", i);
+        CHECK(argparse_multicall_register(mc, names[i], setup_other, names[i]));
+    }
+    CHECK(setups == 0);
+
+    // by the base name of argv[0]
+    args_context_t* ctx = NULL;
+    const char* by_path[] = { "/usr/bin/ls", "-l", NULL };
+    CHECK(argparse_multicall_parse(mc, 2, by_path, &ctx));
+    CHECK(ctx == argparse_multicall_get(mc, "ls") && setups == 1);
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    CHECK(argparse_count(r, "long") == 1);
+    argparse_parse_result_deinit(r);
+
+    // by argv[1], the context built before is reused
+    const char* by_arg[] = { "box", "ls", "--long", NULL };
+    CHECK(argparse_multicall_parse(mc, 3, by_arg, &ctx));
+    CHECK(setups == 1);
+    const char* nested[] = { "box", "cmd57", NULL };
+    CHECK(argparse_multicall_parse(mc, 2, nested, &ctx));
+    CHECK(ctx == argparse_multicall_get(mc, "cmd57") && setups == 2);
+
+    // unknown applets select nothing
+    const char* unknown[] = { "box", "nope", NULL };
+    CHECK(!argparse_multicall_parse(mc, 2, unknown, &ctx));
+    CHECK(argparse_multicall_get(mc, "l") == NULL);
+
+    // an applet failing its setup is selected by argv[0] all the same, argv[1] is not tried
+    const char* broken[] = { "/bin/broken", "ls", NULL };
+    CHECK(!argparse_multicall_parse(mc, 2, broken, &ctx));
+    CHECK(ctx == NULL && setups == 3);
+    // and the setup is not retried
+    CHECK(!argparse_multicall_parse(mc, 2, broken, &ctx));
+    CHECK(argparse_multicall_get(mc, "broken") == NULL);
+    CHECK(setups == 3);
+    argparse_multicall_deinit(mc);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// sorted views: orders are computed over ids, registration order is never changed
+#include "args.h"
+#include "check.h"
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+// order of own parameters of `ctx`
+static std::vector<int> order(args_context_t* ctx, argparse_order_t o) {
+    int ids[1024];
+    int n = argparse_get_parameter_order(ctx, o, ids, 1024);
+    return std::vector<int>(ids, ids + (n > 0 ? n : 0));
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "zeta", 'z', "zeta", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "alpha", 0, "alpha", 0, 0, 1, NULL);
+    argparse_set_section(ctx, "Files");
+    argparse_add_parameter(ctx, NULL, 'm', "m", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "beta", 0, "beta", 0, 0, 1, NULL);
+    argparse_set_section(ctx, "Tuning");
+    argparse_add_parameter(ctx, "gamma", 0, "gamma", 0, 0, 0, NULL);
+    argparse_set_section(ctx, "Files");
+
+    CHECK((order(ctx, ARGPARSE_ORDER_REGISTRATION) == std::vector<int>{ 0, 1, 2, 3, 4 }));
+    // a short term sorts by itself
+    CHECK((order(ctx, ARGPARSE_ORDER_ALPHABETICAL) == std::vector<int>{ 1, 3, 4, 2, 0 }));
+    CHECK((order(ctx, ARGPARSE_ORDER_REQUIRED_FIRST) == std::vector<int>{ 1, 3, 0, 2, 4 }));
+    // no section first, then sections in order of first use
+    CHECK((order(ctx, ARGPARSE_ORDER_SECTION) == std::vector<int>{ 0, 2, 1, 4, 3 }));
+    CHECK(argparse_sort_parameters(ctx));
+    CHECK((order(ctx, ARGPARSE_ORDER_REGISTRATION) == std::vector<int>{ 0, 1, 2, 3, 4 }));
+    CHECK(argparse_get_parameter_order(ctx, (argparse_order_t)9, NULL, 0) == -1);
+
+    // cached orders follow changes of parameters
+    CHECK(argparse_remove_parameter(ctx, "alpha"));
+    argparse_add_parameter(ctx, "aaa", 0, "aaa", 0, 0, 0, NULL);
+    CHECK((order(ctx, ARGPARSE_ORDER_ALPHABETICAL) == std::vector<int>{ 5, 3, 4, 2, 0 }));
+
+    // own parameters come before inherited ones
+    args_context_t* child = argparse_derive_context(ctx);
+    argparse_add_parameter(child, "child", 0, "child", 0, 0, 0, NULL);
+    CHECK(order(child, ARGPARSE_ORDER_REGISTRATION)[0] == 6);
+    CHECK(order(child, ARGPARSE_ORDER_REGISTRATION).size() == 6);
+    deinit_args_context(child);
+    deinit_args_context(ctx);
+
+    // many interleaved sections, against a plain quadratic grouping
+    ctx = init_args_context();
+    static char names[600][8];
+    std::vector<std::string> sections(600);
+    srand(1);
+    for (int i=0; i<600; i++) {
+        snprintf(names[i], sizeof(names[i]), "o%d", i);
+        argparse_add_parameter(ctx, names[i], 0, "o", 0, 0, 0, NULL);
+        if (rand() % 5) {
+            // a fresh copy each time, equal sections need not share a pointer
+            sections[i] = "S" + std::to_string(rand() % 40);
+            argparse_set_section(ctx, sections[i].c_str());
+        }
+    }
+    // no section first, then each section gathered from its first use on
+    std::vector<int> expected;
+    std::vector<bool> done(600);
+    for (int i=0; i<600; i++)
+        if (sections[i].empty()) { expected.push_back(i); done[i] = true; }
+    for (int i=0; i<600; i++) {
+        if (done[i]) continue;
+        for (int j=i; j<600; j++)
+            if (!done[j] && sections[j] == sections[i]) { expected.push_back(j); done[j] = true; }
+    }
+    CHECK(order(ctx, ARGPARSE_ORDER_SECTION) == expected);
+    deinit_args_context(ctx);
+    return 0;
+}
@@ -0,0 +1,72 @@
+// work-stealing pool: every positional task runs once, tasks of a lane run in index order and never overlap
+#include "args.h"
+#include "check.h"
+
+#include <atomic>
+
+#define ARG_COUNT 300
+#define LANES 3
+
+struct tally {
+    std::atomic<int> runs[ARG_COUNT];
+    std::atomic<int> last[LANES];      // last index run in each lane
+    std::atomic<int> busy[LANES];      // tasks of each lane running now
+    std::atomic<int> violations;
+    int fail_index;
+};
+
+static int lane_of(int index, const char* arg, void* user) {
+    // every fourth arg may run in any order
+    return index % 4 == 3 ? -1 : index % LANES;
+}
+
+static int task(int index, const char* arg, void* user) {
+    tally* t = (tally*)user;
+    t->runs[index]++;
+    int lane = lane_of(index, arg, user);
+    if (lane >= 0) {
+        if (t->busy[lane]++ != 0 || t->last[lane].load() >= index)
+            t->violations++;
+        t->last[lane] = index;
+    }
+    // some work, so that other workers get a chance to steal
+    volatile unsigned x = 0;
+    for (int i=0; i<2000; i++)
+        x = x * 31 + i;
+    if (lane >= 0)
+        t->busy[lane]--;
+    return index != t->fail_index;
+}
+
+int main() {
+    static char args[ARG_COUNT][8];
+    const char* argv[ARG_COUNT + 2] = { "prog" };
+    for (int i=0; i<ARG_COUNT; i++) {
+        snprintf(args[i], sizeof(args[i]), "f%d", i);
+        argv[i + 1] = args[i];
+    }
+    static tally t;
+    for (int i=0; i<LANES; i++)
+        t.last[i] = -1;
+    t.fail_index = -1;
+
+    args_context_t* ctx = init_args_context();
+    argparse_set_positional_args(ctx, 0, ARG_COUNT);
+    CHECK(argparse_set_thread_pool(ctx, 4));
+    CHECK(argparse_set_positional_task(ctx, task, lane_of, &t));
+    CHECK(parse_args(ctx, ARG_COUNT + 1, argv));
+    for (int i=0; i<ARG_COUNT; i++)
+        CHECK(t.runs[i] == 1);
+    CHECK(t.violations == 0);
+
+    // a failed task fails the parse and names its positional arg
+    t.fail_index = 42;
+    argparse_set_collect_errors(ctx, 1);
+    CHECK(!parse_args(ctx, ARG_COUNT + 1, argv));
+    int count = 0;
+    const argparse_error_t* e = argparse_get_errors(ctx, &count);
+    CHECK(count == 1 && e->code == ARGPARSE_ERROR_TASK_FAILED && e->count == 42);
+    CHECK_STR(e->text, "f42");
+    deinit_args_context(ctx);
+    return 0;
+}
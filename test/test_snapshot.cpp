@@ -0,0 +1,63 @@
+// snapshots: a relocatable copy of a result, queried without argv or the context, truncated copies are rejected
+#include "args.h"
+#include "check.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+// checks a result of `--name a b -v pos` through the result API
+static int check_result(parse_result_t* r) {
+    parsed_argument_t a;
+    CHECK(argparse_get_parsed_arg(r, "name", &a) && a.parac == 2);
+    CHECK_STR(a.parav[0], "a");
+    CHECK_STR(a.parav[1], "b");
+    CHECK(argparse_count(r, "v") == 1);
+    CHECK(argparse_get_choice(r, "name") == 1);
+    int count = 0;
+    const char** pos = argparse_get_positionals(r, &count);
+    CHECK(count == 1);
+    CHECK_STR(pos[0], "pos");
+    return 0;
+}
+
+int main() {
+    static const char* const choices[] = { "a", "b" };
+    char line[] = "--name a b -v pos";
+    const char* argv[8] = { "prog" };
+    int argc = 1 + argparse_split_line(line, argv + 1, 7);
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 2, 0, NULL);
+    argparse_set_choices(ctx, choices, 2);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 1);
+    CHECK(parse_args(ctx, argc, argv));
+
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    size_t size = argparse_snapshot_size(r);
+    CHECK(size > 0);
+    char* buf = (char*)malloc(size);
+    CHECK(argparse_snapshot_write(r, buf, size - 1) == 0);
+    CHECK(argparse_snapshot_write(r, buf, size) == size);
+    int fd = fileno(tmpfile());
+    CHECK(argparse_snapshot_write_fd(r, fd));
+    argparse_parse_result_deinit(r);
+    deinit_args_context(ctx);
+    // neither argv nor the context are needed any more
+    memset(line, 0, sizeof(line));
+
+    r = argparse_snapshot_attach(buf, size);
+    CHECK(r && check_result(r) == 0);
+    argparse_parse_result_deinit(r);
+    r = argparse_snapshot_attach_fd(fd);
+    CHECK(r && check_result(r) == 0);
+    argparse_parse_result_deinit(r);
+    close(fd);
+
+    // every truncated copy is rejected, so is a damaged header
+    for (size_t n=0; n<size; n++)
+        CHECK(argparse_snapshot_attach(buf, n) == NULL);
+    buf[0] ^= 1;
+    CHECK(argparse_snapshot_attach(buf, size) == NULL);
+    free(buf);
+    return 0;
+}
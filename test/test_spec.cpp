@@ -0,0 +1,77 @@
+// spec publishing: readers see only published versions and keep parsing while writers publish
+#include "args.h"
+#include "check.h"
+
+#include <atomic>
+#include <thread>
+
+static int quiet(args_context_t* ctx, const argparse_error_t* err, void* user) {
+    return 0;
+}
+
+static int parses(args_context_t* reader, const char* arg) {
+    const char* argv[] = { "prog", arg, NULL };
+    return parse_args(reader, 2, argv);
+}
+
+int main() {
+    argparse_spec_t* spec = argparse_spec_init(NULL);
+    args_context_t* draft = argparse_spec_edit(spec);
+    argparse_add_parameter(draft, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_add_parameter(draft, "old", 0, "old", 0, 0, 0, NULL);
+    CHECK(argparse_spec_publish(spec));
+    args_context_t* reader = argparse_spec_attach(spec);
+    argparse_set_error_handle_ex(reader, quiet, NULL);
+    CHECK(parses(reader, "--old"));
+    // readers are read-only
+    CHECK(!argparse_add_parameter(reader, "mine", 0, "mine", 0, 0, 0, NULL));
+
+    // the draft is invisible until published
+    draft = argparse_spec_edit(spec);
+    argparse_add_parameter(draft, "new", 0, "new", 0, 0, 0, NULL);
+    CHECK(argparse_remove_parameter(draft, "old"));
+    CHECK(parses(reader, "--old") && !parses(reader, "--new"));
+    CHECK(argparse_spec_publish(spec));
+    CHECK(!parses(reader, "--old") && parses(reader, "--new"));
+    // the id of a removed parameter is not reused
+    CHECK(argparse_get_parameter_id(reader, "new") == 2);
+
+    // a discarded draft leaves the published version alone
+    draft = argparse_spec_edit(spec);
+    argparse_add_parameter(draft, "dropped", 0, "dropped", 0, 0, 0, NULL);
+    CHECK(argparse_spec_discard(spec));
+    CHECK(!parses(reader, "--dropped"));
+
+    // readers keep parsing on their own threads while versions are published
+    std::atomic<bool> stop(false);
+    std::atomic<int> failures(0);
+    std::thread threads[2];
+    for (std::thread& t : threads) {
+        t = std::thread([&] {
+            args_context_t* r = argparse_spec_attach(spec);
+            argparse_set_error_handle_ex(r, quiet, NULL);
+            while (!stop)
+                if (!parses(r, "-v"))
+                    failures++;
+            deinit_args_context(r);
+        });
+    }
+    static char names[100][8];
+    for (int i=0; i<100; i++) {
+        snprintf(names[i], sizeof(names[i]), "p%d", i);
+        draft = argparse_spec_edit(spec);
+        argparse_add_parameter(draft, names[i], 0, "plugin", 0, 0, 0, NULL);
+        if (i > 0)
+            argparse_remove_parameter(draft, names[i - 1]);
+        CHECK(argparse_spec_publish(spec));
+    }
+    stop = true;
+    for (std::thread& t : threads)
+        t.join();
+    CHECK(failures == 0);
+    CHECK(parses(reader, "--p99") && !parses(reader, "--p98"));
+
+    deinit_args_context(reader);
+    argparse_spec_deinit(spec);
+    return 0;
+}
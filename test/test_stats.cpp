@@ -0,0 +1,52 @@
+// memory stats: bytes of a context and its result, and the peak of the last parse
+#include "args.h"
+#include "check.h"
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "list", 'l', "list", 1, 100, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 100);
+
+    argparse_memory_stats_t empty;
+    CHECK(argparse_get_memory_stats(ctx, &empty));
+    CHECK(empty.arg_info_count == 2 && empty.trie_node_count > 0);
+    CHECK(empty.result_item_count == 0 && empty.result_item_bytes == 0);
+    CHECK(empty.total_bytes == empty.context_bytes + empty.trie_node_bytes + empty.arg_info_bytes
+                               + empty.positional_bytes + empty.string_bytes);
+    CHECK(empty.peak_parse_bytes == empty.total_bytes);
+
+    // the result owned by the context is counted, the peak is the context plus the result grown so far
+    const char* big[64] = { "prog", "-l" };
+    for (int i=2; i<63; i++)
+        big[i] = "v";
+    CHECK(parse_args(ctx, 63, big));
+    argparse_memory_stats_t s;
+    CHECK(argparse_get_memory_stats(ctx, &s));
+    CHECK(s.result_item_count == 2 && s.result_item_bytes > 0);
+    CHECK(s.total_bytes == empty.total_bytes + s.result_item_bytes);
+    CHECK(s.peak_parse_bytes == s.total_bytes);
+
+    // a taken result is counted by itself and no longer by the context
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    argparse_memory_stats_t rs;
+    CHECK(argparse_get_result_memory_stats(r, &rs));
+    CHECK(rs.result_item_bytes == s.result_item_bytes && rs.context_bytes == 0);
+    CHECK(argparse_get_memory_stats(ctx, &s));
+    CHECK(s.result_item_bytes == 0 && s.total_bytes == empty.total_bytes);
+    CHECK(s.peak_parse_bytes == s.total_bytes + rs.result_item_bytes);
+
+    // the peak belongs to the last parse, a smaller parse into a fresh result lowers it
+    const char* small[] = { "prog", "-n", "x", NULL };
+    CHECK(parse_args(ctx, 3, small));
+    argparse_memory_stats_t t;
+    CHECK(argparse_get_memory_stats(ctx, &t));
+    CHECK(t.peak_parse_bytes == t.total_bytes);
+    CHECK(t.result_item_bytes < rs.result_item_bytes);
+    argparse_parse_result_deinit(r);
+
+    CHECK(!argparse_get_memory_stats(NULL, &s));
+    CHECK(!argparse_get_result_memory_stats(NULL, &s));
+    deinit_args_context(ctx);
+    return 0;
+}
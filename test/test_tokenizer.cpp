@@ -0,0 +1,43 @@
+// in-place tokenizer of the command interpreter: shell quoting, tokens written back into the line
+#include "args.h"
+#include "check.h"
+
+int main() {
+    char line[] = "set  'a b' \"c \\\"d\\\"\" e\\ f g\"h\"i  # comment";
+    const char* argv[8];
+    CHECK(argparse_split_line(line, argv, 8) == 5);
+    CHECK_STR(argv[0], "set");
+    CHECK_STR(argv[1], "a b");
+    CHECK_STR(argv[2], "c \"d\"");
+    CHECK_STR(argv[3], "e f");
+    CHECK_STR(argv[4], "ghi");
+    // no copies, every token lives in the line
+    for (int i=0; i<5; i++)
+        CHECK(argv[i] >= line && argv[i] < line + sizeof(line));
+
+    char unterminated[] = "echo 'abc";
+    CHECK(argparse_split_line(unterminated, argv, 8) == -1);
+    char too_many[] = "a b c";
+    CHECK(argparse_split_line(too_many, argv, 2) == -1);
+    char empty[] = "   # only a comment";
+    CHECK(argparse_split_line(empty, argv, 8) == 0);
+
+    // the interpreter parses every line against the same context, values point into the line
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, NULL);
+    argparse_interpreter_t* it = argparse_interpreter_init(ctx, "console");
+    char cmd[] = "--name 'x y'";
+    CHECK(argparse_interpreter_exec(it, cmd));
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    parsed_argument_t a;
+    CHECK(argparse_get_parsed_arg(r, "name", &a) && a.parac == 1);
+    CHECK_STR(a.parav[0], "x y");
+    CHECK(a.parav[0] >= cmd && a.parav[0] < cmd + sizeof(cmd));
+    argparse_parse_result_deinit(r);
+    char bad[] = "--name \"x";
+    CHECK(!argparse_interpreter_exec(it, bad));
+    // the interpreter keeps its own allocator and may be freed after the context
+    deinit_args_context(ctx);
+    argparse_interpreter_deinit(it);
+    return 0;
+}
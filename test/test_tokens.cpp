@@ -0,0 +1,50 @@
+// argv pre-pass: every token is classified once, the parse loop branches on its kind
+#include "args.h"
+#include "check.h"
+
+static const char* value_of(parse_result_t* r, const char* name, int i) {
+    parsed_argument_t a;
+    if (!argparse_get_parsed_arg(r, name, &a) || a.parac <= i)
+        return NULL;
+    return a.parav[i];
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "a-rather-long-option-name", 0, "long", 1, 1, 0, NULL);
+    argparse_add_parameter(ctx, "list", 'l', "list", 1, 3, 0, NULL);
+    argpaese_add_short_leading_parameter(ctx, 'D', "define", 0, NULL);
+    argparse_enable_remove_ambiguous(ctx);
+    argparse_set_positional_args(ctx, 0, 10);
+
+    // long with value, long, short with leading value, positional with '=', separator
+    const char* argv[] = { "prog", "--name=a=b", "--a-rather-long-option-name", "x", "-Dk=v", "p=q",
+                           "-l", "1", "2", "--", "3", NULL };
+    CHECK(parse_args(ctx, 11, argv));
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    // the value of a long token starts after its first '='
+    CHECK_STR(value_of(r, "name", 0), "a=b");
+    CHECK_STR(value_of(r, "a-rather-long-option-name", 0), "x");
+    CHECK_STR(value_of(r, "D", 0), "k=v");
+    // the separator ends the values of -l
+    CHECK(argparse_count(r, "list") == 1);
+    CHECK_STR(value_of(r, "list", 1), "2");
+    CHECK(!value_of(r, "list", 2));
+    int count = 0;
+    const char** positionals = argparse_get_positionals(r, &count);
+    CHECK(count == 2);
+    CHECK_STR(positionals[0], "p=q");
+    CHECK_STR(positionals[1], "3");
+    argparse_parse_result_deinit(r);
+
+    // a '=' far into a long token, and an abbreviated long token with a value
+    const char* longer[] = { "prog", "--a-rather-long-option-name=y", "--na=z", NULL };
+    CHECK(parse_args(ctx, 3, longer));
+    r = argparse_get_last_parse_result(ctx);
+    CHECK_STR(value_of(r, "a-rather-long-option-name", 0), "y");
+    CHECK_STR(value_of(r, "name", 0), "z");
+    argparse_parse_result_deinit(r);
+    deinit_args_context(ctx);
+    return 0;
+}
@@ -0,0 +1,106 @@
+// parse trace: events of a parse in order, the oldest overwritten once the ring is full
+#include "args.h"
+#include "check.h"
+
+static int calls = 0;
+
+static void on_name(args_context_t* ctx, int parac, const char** parav) {
+    calls++;
+}
+
+// index of the first event of `type` at or after `from`, -1 if none
+static int find(const argparse_trace_event_t* e, int n, int from, int type) {
+    for (int i=from; i<n; i++)
+        if (e[i].type == type)
+            return i;
+    return -1;
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, on_name);
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 10);
+    const int name = argparse_get_parameter_id(ctx, "name");
+
+    // disabled by default
+    const char* argv[] = { "prog", "--na", "x", "pos", "-v", NULL };
+    CHECK(parse_args(ctx, 5, argv));
+    CHECK(argparse_get_trace(ctx, NULL, 0) == 0);
+
+    CHECK(argparse_set_trace(ctx, 1000));
+    CHECK(parse_args(ctx, 5, argv));
+    argparse_trace_event_t e[1024];
+    const int n = argparse_get_trace(ctx, e, 1024);
+    CHECK(n > 8 && n < 1024);
+    CHECK(e[0].type == ARGPARSE_TRACE_PARSE && e[0].data == 5);
+    for (int i=1; i<n; i++)
+        CHECK(e[i].time_ns >= e[i-1].time_ns);
+    // the abbreviated token is looked up and resolved before its value is attached
+    int token = find(e, n, 0, ARGPARSE_TRACE_TOKEN);
+    CHECK(token > 0 && e[token].argv_index == 1);
+    int node = find(e, n, token, ARGPARSE_TRACE_NODE);
+    CHECK(node > token && e[node].id == name && e[node].data == 0 && e[node].argv_index == 1);
+    int abbrev = find(e, n, node, ARGPARSE_TRACE_ABBREV);
+    CHECK(abbrev > node && e[abbrev].id == name && e[abbrev].data == 2);
+    int value = find(e, n, abbrev, ARGPARSE_TRACE_VALUE);
+    CHECK(value > abbrev && e[value].id == name && e[value].argv_index == 2 && e[value].data == 0);
+    int enter = find(e, n, value, ARGPARSE_TRACE_CALLBACK_ENTER);
+    CHECK(enter > value && e[enter].id == name && e[enter].data == 1);
+    CHECK(e[enter + 1].type == ARGPARSE_TRACE_CALLBACK_EXIT && e[enter + 1].id == name);
+    int positional = find(e, n, value + 1, ARGPARSE_TRACE_VALUE);
+    CHECK(positional > value && e[positional].id == -1 && e[positional].argv_index == 3);
+    // tokens come in argv order, with their kinds
+    const int kinds[] = { 0, ARGPARSE_TOKEN_LONG, ARGPARSE_TOKEN_VALUE, ARGPARSE_TOKEN_VALUE, ARGPARSE_TOKEN_SHORT };
+    CHECK(e[token].data == ARGPARSE_TOKEN_LONG);
+    for (int i=find(e, n, token + 1, ARGPARSE_TRACE_TOKEN), last = 1; i >= 0; i = find(e, n, i + 1, ARGPARSE_TRACE_TOKEN)) {
+        CHECK(e[i].argv_index == last + 1 && e[i].data == kinds[e[i].argv_index]);
+        last = e[i].argv_index;
+    }
+    CHECK(find(e, n, 0, ARGPARSE_TRACE_ERROR) == -1);
+    // fewer slots than events receive the most recent ones
+    argparse_trace_event_t tail[3];
+    CHECK(argparse_get_trace(ctx, tail, 3) == n);
+    for (int i=0; i<3; i++)
+        CHECK(tail[i].type == e[n - 3 + i].type && tail[i].time_ns == e[n - 3 + i].time_ns);
+
+    // a ring of 4 keeps the last 4 events of the same parse
+    CHECK(argparse_set_trace(ctx, 3));
+    CHECK(parse_args(ctx, 5, argv));
+    argparse_trace_event_t ring[8];
+    CHECK(argparse_get_trace(ctx, ring, 8) == 4);
+    for (int i=0; i<4; i++) {
+        const argparse_trace_event_t* x = &e[n - 4 + i];
+        CHECK(ring[i].type == x->type && ring[i].argv_index == x->argv_index && ring[i].id == x->id && ring[i].data == x->data);
+    }
+    // and keeps wrapping over later parses
+    CHECK(parse_args(ctx, 5, argv));
+    CHECK(argparse_get_trace(ctx, ring, 8) == 4);
+    CHECK(ring[3].type == e[n - 1].type && ring[3].time_ns > e[n - 1].time_ns);
+
+    // an inline value and the separator have kinds of their own
+    argparse_add_parameter(ctx, "level", 'l', "level", 1, 1, 0, NULL);
+    argparse_enable_remove_ambiguous(ctx);
+    const char* inline_value[] = { "prog", "--level=y", "--", "z", NULL };
+    CHECK(argparse_set_trace(ctx, 64));
+    CHECK(parse_args(ctx, 4, inline_value));
+    int m = argparse_get_trace(ctx, e, 64);
+    token = find(e, m, 0, ARGPARSE_TRACE_TOKEN);
+    CHECK(token > 0 && e[token].data == ARGPARSE_TOKEN_LONG_VALUE);
+    token = find(e, m, token + 1, ARGPARSE_TRACE_TOKEN);
+    CHECK(token > 0 && e[token].argv_index == 2 && e[token].data == ARGPARSE_TOKEN_SEPARATOR);
+
+    // errors are traced with their code
+    argparse_set_error_handle_ex(ctx, [](args_context_t*, const argparse_error_t*, void*) { return 0; }, NULL);
+    const char* bad[] = { "prog", "--nope", NULL };
+    CHECK(!parse_args(ctx, 2, bad));
+    m = argparse_get_trace(ctx, e, 64);
+    int error = find(e, m, 0, ARGPARSE_TRACE_ERROR);
+    CHECK(error > 0 && e[error].data == ARGPARSE_ERROR_UNKNOWN_OPTION && e[error].argv_index == 1);
+
+    CHECK(argparse_set_trace(ctx, 0));
+    CHECK(argparse_get_trace(ctx, e, 64) == 0);
+    CHECK(calls == 4);
+    deinit_args_context(ctx);
+    return 0;
+}
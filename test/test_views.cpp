@@ -0,0 +1,47 @@
+// views: arguments are slices of one buffer, nothing past a slice is read and values keep their lengths
+#include "args.h"
+#include "check.h"
+
+static int view_is(const argparse_view_t& v, const char* s) {
+    return v.len == strlen(s) && memcmp(v.ptr, s, v.len) == 0;
+}
+
+int main() {
+    args_context_t* ctx = init_args_context();
+    argparse_add_parameter(ctx, "verbose", 'v', "verbose", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "x-ray", 'x', "must not be seen", 0, 0, 0, NULL);
+    argparse_add_parameter(ctx, "name", 'n', "name", 1, 1, 0, NULL);
+    argparse_set_positional_args(ctx, 0, 4);
+
+    // slices end in the middle of the buffer: "-v" is followed by "x", "--name=ab" by "c"
+    const char buf[] = "prog-vx--name=abcfirst-n1 second";
+    const argparse_view_t argv[] = {
+        { buf, 4 }, { buf + 4, 2 }, { buf + 7, 9 }, { buf + 17, 5 }, { buf + 22, 2 }, { buf + 24, 1 },
+        { buf + 26, 6 },
+    };
+    CHECK(parse_args_views(ctx, 7, argv));
+    parse_result_t* r = argparse_get_last_parse_result(ctx);
+    CHECK(argparse_count(r, "verbose") == 1);
+    CHECK(argparse_count(r, "x-ray") == 0);
+
+    argparse_view_t v[4];
+    CHECK(argparse_get_parsed_views(r, "name", v, 4) == 2);
+    CHECK(view_is(v[0], "ab"));
+    CHECK(view_is(v[1], "1"));
+    // values are not copied
+    CHECK(v[0].ptr == buf + 14);
+    CHECK(argparse_get_positional_views(r, v, 4) == 2);
+    CHECK(view_is(v[0], "first"));
+    CHECK(view_is(v[1], "second"));
+    CHECK(argparse_get_parsed_views(r, "nope", v, 4) == -1);
+    argparse_parse_result_deinit(r);
+
+    // the same result API reads results of parse_args()
+    const char* plain[] = { "prog", "--name", "xyz", NULL };
+    CHECK(parse_args(ctx, 3, plain));
+    r = argparse_get_last_parse_result(ctx);
+    CHECK(argparse_get_parsed_views(r, "name", v, 4) == 1 && view_is(v[0], "xyz"));
+    argparse_parse_result_deinit(r);
+    deinit_args_context(ctx);
+    return 0;
+}